@@ -27,6 +27,7 @@
 #include <flash/nor/core.h>
 #include <flash/nor/imp.h>
 #include <target/image.h>
+#include <helper/perf.h>
 
 /**
  * @file
@@ -39,9 +40,12 @@ static struct flash_bank *flash_banks;
 
 int flash_driver_erase(struct flash_bank *bank, int first, int last)
 {
+	static struct perf_stat erase_stat = PERF_STAT_INIT("flash.erase");
+	int64_t start = perf_start();
 	int retval;
 
 	retval = bank->driver->erase(bank, first, last);
+	perf_end(&erase_stat, start, last - first + 1, 0, retval);
 	if (retval != ERROR_OK)
 		LOG_ERROR("failed erasing sectors %d to %d", first, last);
 
@@ -94,9 +98,12 @@ int flash_driver_protect(struct flash_bank *bank, int set, int first, int last)
 int flash_driver_write(struct flash_bank *bank,
 	uint8_t *buffer, uint32_t offset, uint32_t count)
 {
+	static struct perf_stat write_stat = PERF_STAT_INIT("flash.write");
+	int64_t start = perf_start();
 	int retval;
 
 	retval = bank->driver->write(bank, buffer, offset, count);
+	perf_end(&write_stat, start, 1, count, retval);
 	if (retval != ERROR_OK) {
 		LOG_ERROR(
 			"error writing to flash at address 0x%08" PRIx32 " at offset 0x%8.8" PRIx32,
@@ -110,11 +117,14 @@ int flash_driver_write(struct flash_bank *bank,
 int flash_driver_read(struct flash_bank *bank,
 	uint8_t *buffer, uint32_t offset, uint32_t count)
 {
+	static struct perf_stat read_stat = PERF_STAT_INIT("flash.read");
+	int64_t start = perf_start();
 	int retval;
 
 	LOG_DEBUG("call flash_driver_read()");
 
 	retval = bank->driver->read(bank, buffer, offset, count);
+	perf_end(&read_stat, start, 1, count, retval);
 	if (retval != ERROR_OK) {
 		LOG_ERROR(
 			"error reading to flash at address 0x%08" PRIx32 " at offset 0x%8.8" PRIx32,
@@ -736,6 +746,7 @@ int flash_write_unlock(struct target *target, struct image *image,
 	while (section < image->num_sections) {
 		uint32_t buffer_idx;
 		uint8_t *buffer;
+		uint8_t *data;
 		int section_last;
 		target_addr_t run_address = sections[section]->base_address + section_offset;
 		uint32_t run_size = sections[section]->size - section_offset;
@@ -863,18 +874,45 @@ int flash_write_unlock(struct target *target, struct image *image,
 			run_size += delta;
 		}
 
-		/* allocate buffer */
-		buffer = malloc(run_size);
-		if (buffer == NULL) {
-			LOG_ERROR("Out of memory for flash bank buffer");
-			retval = ERROR_FAIL;
-			goto done;
+		buffer = NULL;
+		data = NULL;
+
+		/* a run covering part of a single section without any padding can
+		 * be written straight from the image, without an intermediate copy */
+		if (section_last == section && !padding_at_start && !padding[section]
+				&& run_size <= sections[section]->size - section_offset) {
+			intptr_t diff = (intptr_t)sections[section] - (intptr_t)image->sections;
+			int t_section_num = diff / sizeof(struct imagesection);
+
+			if (image_get_section_view(image, t_section_num, section_offset,
+					run_size, &data) == ERROR_OK) {
+				section_offset += run_size;
+				if (section_offset >= sections[section]->size) {
+					section++;
+					section_offset = 0;
+				}
+			} else {
+				data = NULL;
+			}
 		}
 
-		if (padding_at_start)
-			memset(buffer, c->default_padded_value, padding_at_start);
+		if (data == NULL) {
+			/* allocate buffer */
+			buffer = malloc(run_size);
+			if (buffer == NULL) {
+				LOG_ERROR("Out of memory for flash bank buffer");
+				retval = ERROR_FAIL;
+				goto done;
+			}
+
+			if (padding_at_start)
+				memset(buffer, c->default_padded_value, padding_at_start);
 
-		buffer_idx = padding_at_start;
+			buffer_idx = padding_at_start;
+			data = buffer;
+		} else {
+			buffer_idx = run_size;
+		}
 
 		/* read sections to the buffer */
 		while (buffer_idx < run_size) {
@@ -932,7 +970,7 @@ int flash_write_unlock(struct target *target, struct image *image,
 
 		if (retval == ERROR_OK) {
 			/* write flash sectors */
-			retval = flash_driver_write(c, buffer, run_address - c->base, run_size);
+			retval = flash_driver_write(c, data, run_address - c->base, run_size);
 		}
 
 		free(buffer);
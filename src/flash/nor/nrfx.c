@@ -1079,9 +1079,10 @@ static int nrfx_ll_flash_write(struct nrfx_info *chip, uint32_t offset, const ui
 	LOG_DEBUG("Writing buffer to flash offset=0x%"PRIx32" bytes=0x%"PRIx32, offset, bytes);
 	assert(bytes % 4 == 0);
 
-	/* allocate working area with flash programming code */
-	if (target_alloc_working_area(target, sizeof(nrfx_flash_write_code),
-			&write_algorithm) != ERROR_OK) {
+	/* allocate working area with flash programming code, the code stays
+	 * resident between calls */
+	if (target_alloc_algorithm_working_area(target, nrfx_flash_write_code,
+			sizeof(nrfx_flash_write_code), &write_algorithm) != ERROR_OK) {
 		LOG_WARNING("no working area available, falling back to slow memory writes");
 
 		for (; bytes > 0; bytes -= 4) {
@@ -1104,19 +1105,13 @@ static int nrfx_ll_flash_write(struct nrfx_info *chip, uint32_t offset, const ui
 	LOG_WARNING("only with ST-Link and CMSIS-DAP. If you have issues, add");
 	LOG_WARNING("\"set WORKAREASIZE 0\" before sourcing nrf51.cfg/nrf52.cfg to disable it");
 
-	retval = target_write_buffer(target, write_algorithm->address,
-				sizeof(nrfx_flash_write_code),
-				nrfx_flash_write_code);
-	if (retval != ERROR_OK)
-		return retval;
-
 	/* memory buffer */
 	while (target_alloc_working_area(target, buffer_size, &source) != ERROR_OK) {
 		buffer_size /= 2;
 		buffer_size &= ~3UL; /* Make sure it's 4 byte aligned */
 		if (buffer_size <= 256) {
 			/* free working area, write algorithm already allocated */
-			target_free_working_area(target, write_algorithm);
+			target_free_algorithm_working_area(target, write_algorithm);
 
 			LOG_WARNING("No large enough working area available, can't do block memory writes");
 			return ERROR_TARGET_RESOURCE_NOT_AVAILABLE;
@@ -1144,7 +1139,7 @@ static int nrfx_ll_flash_write(struct nrfx_info *chip, uint32_t offset, const ui
 			&armv7m_info);
 
 	target_free_working_area(target, source);
-	target_free_working_area(target, write_algorithm);
+	target_free_algorithm_working_area(target, write_algorithm);
 
 	destroy_reg_param(&reg_params[0]);
 	destroy_reg_param(&reg_params[1]);
@@ -26,25 +26,6 @@
 #include "log.h"
 #include "binarybuffer.h"
 
-static const unsigned char bit_reverse_table256[] = {
-	0x00, 0x80, 0x40, 0xC0, 0x20, 0xA0, 0x60, 0xE0, 0x10, 0x90, 0x50, 0xD0, 0x30, 0xB0, 0x70, 0xF0,
-	0x08, 0x88, 0x48, 0xC8, 0x28, 0xA8, 0x68, 0xE8, 0x18, 0x98, 0x58, 0xD8, 0x38, 0xB8, 0x78, 0xF8,
-	0x04, 0x84, 0x44, 0xC4, 0x24, 0xA4, 0x64, 0xE4, 0x14, 0x94, 0x54, 0xD4, 0x34, 0xB4, 0x74, 0xF4,
-	0x0C, 0x8C, 0x4C, 0xCC, 0x2C, 0xAC, 0x6C, 0xEC, 0x1C, 0x9C, 0x5C, 0xDC, 0x3C, 0xBC, 0x7C, 0xFC,
-	0x02, 0x82, 0x42, 0xC2, 0x22, 0xA2, 0x62, 0xE2, 0x12, 0x92, 0x52, 0xD2, 0x32, 0xB2, 0x72, 0xF2,
-	0x0A, 0x8A, 0x4A, 0xCA, 0x2A, 0xAA, 0x6A, 0xEA, 0x1A, 0x9A, 0x5A, 0xDA, 0x3A, 0xBA, 0x7A, 0xFA,
-	0x06, 0x86, 0x46, 0xC6, 0x26, 0xA6, 0x66, 0xE6, 0x16, 0x96, 0x56, 0xD6, 0x36, 0xB6, 0x76, 0xF6,
-	0x0E, 0x8E, 0x4E, 0xCE, 0x2E, 0xAE, 0x6E, 0xEE, 0x1E, 0x9E, 0x5E, 0xDE, 0x3E, 0xBE, 0x7E, 0xFE,
-	0x01, 0x81, 0x41, 0xC1, 0x21, 0xA1, 0x61, 0xE1, 0x11, 0x91, 0x51, 0xD1, 0x31, 0xB1, 0x71, 0xF1,
-	0x09, 0x89, 0x49, 0xC9, 0x29, 0xA9, 0x69, 0xE9, 0x19, 0x99, 0x59, 0xD9, 0x39, 0xB9, 0x79, 0xF9,
-	0x05, 0x85, 0x45, 0xC5, 0x25, 0xA5, 0x65, 0xE5, 0x15, 0x95, 0x55, 0xD5, 0x35, 0xB5, 0x75, 0xF5,
-	0x0D, 0x8D, 0x4D, 0xCD, 0x2D, 0xAD, 0x6D, 0xED, 0x1D, 0x9D, 0x5D, 0xDD, 0x3D, 0xBD, 0x7D, 0xFD,
-	0x03, 0x83, 0x43, 0xC3, 0x23, 0xA3, 0x63, 0xE3, 0x13, 0x93, 0x53, 0xD3, 0x33, 0xB3, 0x73, 0xF3,
-	0x0B, 0x8B, 0x4B, 0xCB, 0x2B, 0xAB, 0x6B, 0xEB, 0x1B, 0x9B, 0x5B, 0xDB, 0x3B, 0xBB, 0x7B, 0xFB,
-	0x07, 0x87, 0x47, 0xC7, 0x27, 0xA7, 0x67, 0xE7, 0x17, 0x97, 0x57, 0xD7, 0x37, 0xB7, 0x77, 0xF7,
-	0x0F, 0x8F, 0x4F, 0xCF, 0x2F, 0xAF, 0x6F, 0xEF, 0x1F, 0x9F, 0x5F, 0xDF, 0x3F, 0xBF, 0x7F, 0xFF
-};
-
 static const char hex_digits[] = {
 	'0', '1', '2', '3', '4', '5', '6', '7', '8', '9',
 	'a', 'b', 'c', 'd', 'e', 'f'
@@ -84,7 +65,7 @@ bool buf_cmp(const void *_buf1, const void *_buf2, unsigned size)
 
 	unsigned last = size / 8;
 	if (memcmp(_buf1, _buf2, last) != 0)
-		return false;
+		return true;
 
 	unsigned trailing = size % 8;
 	if (!trailing)
@@ -102,7 +83,14 @@ bool buf_cmp_mask(const void *_buf1, const void *_buf2,
 
 	const uint8_t *buf1 = _buf1, *buf2 = _buf2, *mask = _mask;
 	unsigned last = size / 8;
-	for (unsigned i = 0; i < last; i++) {
+	unsigned i = 0;
+
+	/* compare eight bytes at a time, the bulk of long SVF vectors */
+	for (; i + 8 <= last; i += 8) {
+		if ((le_to_h_u64(buf1 + i) ^ le_to_h_u64(buf2 + i)) & le_to_h_u64(mask + i))
+			return true;
+	}
+	for (; i < last; i++) {
 		if (buf_cmp_masked(buf1[i], buf2[i], mask[i]))
 			return true;
 	}
@@ -133,52 +121,78 @@ void *buf_set_buf(const void *_src, unsigned src_start,
 {
 	const uint8_t *src = _src;
 	uint8_t *dst = _dst;
-	unsigned i, sb, db, sq, dq, lb, lq;
+	unsigned sq, dq;
 
-	sb = src_start / 8;
-	db = dst_start / 8;
+	src += src_start / 8;
+	dst += dst_start / 8;
 	sq = src_start % 8;
 	dq = dst_start % 8;
-	lb = len / 8;
-	lq = len % 8;
-
-	src += sb;
-	dst += db;
-
-	/* check if both buffers are on byte boundary and
-	 * len is a multiple of 8bit so we can simple copy
-	 * the buffer */
-	if ((sq == 0) && (dq == 0) &&  (lq == 0)) {
-		for (i = 0; i < lb; i++)
-			*dst++ = *src++;
-		return _dst;
-	}
 
-	/* fallback to slow bit copy */
-	for (i = 0; i < len; i++) {
-		if (((*src >> (sq&7)) & 1) == 1)
-			*dst |= 1 << (dq&7);
+	/* copy single bits until the destination is on a byte boundary */
+	while (len && dq) {
+		if ((*src >> sq) & 1)
+			*dst |= 1 << dq;
 		else
-			*dst &= ~(1 << (dq&7));
-		if (sq++ == 7) {
+			*dst &= ~(1 << dq);
+		len--;
+		if (++sq == 8) {
 			sq = 0;
 			src++;
 		}
-		if (dq++ == 7) {
+		if (++dq == 8) {
 			dq = 0;
 			dst++;
 		}
 	}
 
+	if (sq == 0) {
+		/* both buffers are on a byte boundary, simply copy */
+		memcpy(dst, src, len / 8);
+		src += len / 8;
+		dst += len / 8;
+	} else {
+		/* Assemble whole destination bytes from two neighbouring source
+		 * bytes, 64 bits at a time as long as possible. All source bytes
+		 * read hold at least one bit which is part of the copy. */
+		while (len >= 64) {
+			uint64_t w = le_to_h_u64(src) >> sq;
+			w |= (uint64_t)src[8] << (64 - sq);
+			h_u64_to_le(dst, w);
+			src += 8;
+			dst += 8;
+			len -= 64;
+		}
+		while (len >= 8) {
+			*dst++ = (src[0] >> sq) | (src[1] << (8 - sq));
+			src++;
+			len -= 8;
+		}
+	}
+	len %= 8;
+
+	/* remaining bits */
+	for (dq = 0; dq < len; dq++) {
+		if ((*src >> sq) & 1)
+			*dst |= 1 << dq;
+		else
+			*dst &= ~(1 << dq);
+		if (++sq == 8) {
+			sq = 0;
+			src++;
+		}
+	}
+
 	return _dst;
 }
 
 uint32_t flip_u32(uint32_t value, unsigned int num)
 {
-	uint32_t c = (bit_reverse_table256[value & 0xff] << 24) |
-		(bit_reverse_table256[(value >> 8) & 0xff] << 16) |
-		(bit_reverse_table256[(value >> 16) & 0xff] << 8) |
-		(bit_reverse_table256[(value >> 24) & 0xff]);
+	/* swap ever larger groups of bits: 1, 2, 4, then the bytes */
+	uint32_t c = value;
+	c = ((c >> 1) & 0x55555555) | ((c & 0x55555555) << 1);
+	c = ((c >> 2) & 0x33333333) | ((c & 0x33333333) << 2);
+	c = ((c >> 4) & 0x0f0f0f0f) | ((c & 0x0f0f0f0f) << 4);
+	c = (c >> 24) | ((c >> 8) & 0xff00) | ((c & 0xff00) << 8) | (c << 24);
 
 	if (num < 32)
 		c = c >> (32 - num);
@@ -331,6 +345,10 @@ int str_to_buf(const char *str, unsigned str_len,
 	return i;
 }
 
+/* entries released by bit_copy_execute()/bit_copy_discard(), kept for reuse
+ * so that queueing a copy per scan field does not cost a malloc() each */
+static LIST_HEAD(bit_copy_free_entries);
+
 void bit_copy_queue_init(struct bit_copy_queue *q)
 {
 	INIT_LIST_HEAD(&q->list);
@@ -339,9 +357,16 @@ void bit_copy_queue_init(struct bit_copy_queue *q)
 int bit_copy_queued(struct bit_copy_queue *q, uint8_t *dst, unsigned dst_offset, const uint8_t *src,
 	unsigned src_offset, unsigned bit_count)
 {
-	struct bit_copy_queue_entry *qe = malloc(sizeof(*qe));
-	if (!qe)
-		return ERROR_FAIL;
+	struct bit_copy_queue_entry *qe;
+
+	if (!list_empty(&bit_copy_free_entries)) {
+		qe = list_first_entry(&bit_copy_free_entries, struct bit_copy_queue_entry, list);
+		list_del(&qe->list);
+	} else {
+		qe = malloc(sizeof(*qe));
+		if (!qe)
+			return ERROR_FAIL;
+	}
 
 	qe->dst = dst;
 	qe->dst_offset = dst_offset;
@@ -356,22 +381,15 @@ int bit_copy_queued(struct bit_copy_queue *q, uint8_t *dst, unsigned dst_offset,
 void bit_copy_execute(struct bit_copy_queue *q)
 {
 	struct bit_copy_queue_entry *qe;
-	struct bit_copy_queue_entry *tmp;
-	list_for_each_entry_safe(qe, tmp, &q->list, list) {
+	list_for_each_entry(qe, &q->list, list)
 		bit_copy(qe->dst, qe->dst_offset, qe->src, qe->src_offset, qe->bit_count);
-		list_del(&qe->list);
-		free(qe);
-	}
+
+	list_splice_init(&q->list, &bit_copy_free_entries);
 }
 
 void bit_copy_discard(struct bit_copy_queue *q)
 {
-	struct bit_copy_queue_entry *qe;
-	struct bit_copy_queue_entry *tmp;
-	list_for_each_entry_safe(qe, tmp, &q->list, list) {
-		list_del(&qe->list);
-		free(qe);
-	}
+	list_splice_init(&q->list, &bit_copy_free_entries);
 }
 
 /**
@@ -444,21 +462,32 @@ size_t hexify(char *hex, const uint8_t *bin, size_t count, size_t length)
 
 void buffer_shr(void *_buf, unsigned buf_len, unsigned count)
 {
-	unsigned i;
 	unsigned char *buf = _buf;
-	unsigned bytes_to_remove;
-	unsigned shift;
-
-	bytes_to_remove = count / 8;
-	shift = count - (bytes_to_remove * 8);
-
-	for (i = 0; i < (buf_len - 1); i++)
-		buf[i] = (buf[i] >> shift) | ((buf[i+1] << (8 - shift)) & 0xff);
+	unsigned bytes_to_remove = count / 8;
+	unsigned shift = count % 8;
 
-	buf[(buf_len - 1)] = buf[(buf_len - 1)] >> shift;
+	if (bytes_to_remove >= buf_len) {
+		memset(buf, 0, buf_len);
+		return;
+	}
 
-	if (bytes_to_remove) {
-		memmove(buf, &buf[bytes_to_remove], buf_len - bytes_to_remove);
-		memset(&buf[buf_len - bytes_to_remove], 0, bytes_to_remove);
+	unsigned len = buf_len - bytes_to_remove;
+	const unsigned char *src = buf + bytes_to_remove;
+
+	if (shift == 0) {
+		memmove(buf, src, len);
+	} else {
+		/* reading always stays ahead of (or on) the byte being written */
+		unsigned i = 0;
+		for (; i + 8 < len; i += 8) {
+			uint64_t w = le_to_h_u64(src + i) >> shift;
+			w |= (uint64_t)src[i + 8] << (64 - shift);
+			h_u64_to_le(buf + i, w);
+		}
+		for (; i < len - 1; i++)
+			buf[i] = (src[i] >> shift) | ((src[i + 1] << (8 - shift)) & 0xff);
+		buf[len - 1] = src[len - 1] >> shift;
 	}
+
+	memset(buf + len, 0, bytes_to_remove);
 }
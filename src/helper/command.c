@@ -39,6 +39,7 @@
 #include "configuration.h"
 #include "log.h"
 #include "time_support.h"
+#include "perf.h"
 #include "jim-eventloop.h"
 
 /* nice short description of source file */
@@ -620,8 +621,13 @@ static int run_command(struct command_context *context,
 	if (c->jim_handler_data)
 		context->current_target_override = c->jim_handler_data;
 
+	static struct perf_stat command_stat = PERF_STAT_INIT("tcl.command");
+	int64_t start = perf_start();
+
 	int retval = c->handler(&cmd);
 
+	perf_end_detail(&command_stat, c->name, start, 1, 0, retval);
+
 	if (c->jim_handler_data)
 		context->current_target_override = saved_target_override;
 
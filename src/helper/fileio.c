@@ -30,12 +30,19 @@
 #include "configuration.h"
 #include "fileio.h"
 
+#ifdef HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#endif
+
 struct fileio {
 	char *url;
 	size_t size;
 	enum fileio_type type;
 	enum fileio_access access;
 	FILE *file;
+	/* whole file content, see fileio_map() */
+	void *map;
+	bool map_is_mmap;
 };
 
 static inline int fileio_close_local(struct fileio *fileio)
@@ -127,6 +134,8 @@ int fileio_open(struct fileio **fileio, const char *url,
 	tmp->type = type;
 	tmp->access = access_type;
 	tmp->url = strdup(url);
+	tmp->map = NULL;
+	tmp->map_is_mmap = false;
 
 	retval = fileio_open_local(tmp);
 
@@ -145,6 +154,15 @@ int fileio_close(struct fileio *fileio)
 {
 	int retval;
 
+	if (fileio->map) {
+#ifdef HAVE_SYS_MMAN_H
+		if (fileio->map_is_mmap)
+			munmap(fileio->map, fileio->size);
+		else
+#endif
+			free(fileio->map);
+	}
+
 	retval = fileio_close_local(fileio);
 
 	free(fileio->url);
@@ -272,3 +290,66 @@ int fileio_size(struct fileio *fileio, size_t *size)
 
 	return ERROR_OK;
 }
+
+/**
+ * Make the whole content of a file opened for reading available in memory.
+ *
+ * Where possible the file is mapped, so that callers can access any part
+ * of it without seeking and copying through stdio; otherwise it is read
+ * into a buffer once. The memory is a private copy: writes to it do not
+ * reach the file. It stays valid until fileio_close(). An empty file
+ * yields a NULL pointer.
+ *
+ * @param fileio The file, opened with FILEIO_READ.
+ * @param data Set to the start of the file content.
+ * @returns ERROR_OK on success, an error code if the file can not be
+ * mapped or read.
+ */
+int fileio_map(struct fileio *fileio, uint8_t **data)
+{
+	if (fileio->map) {
+		*data = fileio->map;
+		return ERROR_OK;
+	}
+
+	if (fileio->access != FILEIO_READ)
+		return ERROR_FILEIO_OPERATION_NOT_SUPPORTED;
+
+	if (fileio->size == 0) {
+		*data = NULL;
+		return ERROR_OK;
+	}
+
+#ifdef HAVE_SYS_MMAN_H
+	void *map = mmap(NULL, fileio->size, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+			fileno(fileio->file), 0);
+	if (map != MAP_FAILED) {
+		fileio->map = map;
+		fileio->map_is_mmap = true;
+		*data = map;
+		return ERROR_OK;
+	}
+	LOG_DEBUG("couldn't map %s: %s, reading it instead", fileio->url, strerror(errno));
+#endif
+
+	uint8_t *buffer = malloc(fileio->size);
+	if (!buffer) {
+		LOG_ERROR("not enough memory to read %s", fileio->url);
+		return ERROR_FILEIO_OPERATION_FAILED;
+	}
+
+	size_t size_read;
+	if (fseek(fileio->file, 0, SEEK_SET) != 0
+			|| fileio_local_read(fileio, fileio->size, buffer, &size_read) != ERROR_OK
+			|| size_read != fileio->size) {
+		LOG_ERROR("couldn't read %s", fileio->url);
+		free(buffer);
+		return ERROR_FILEIO_OPERATION_FAILED;
+	}
+
+	fileio->map = buffer;
+	fileio->map_is_mmap = false;
+	*data = buffer;
+
+	return ERROR_OK;
+}
@@ -59,6 +59,7 @@ int fileio_write(struct fileio *fileio,
 int fileio_read_u32(struct fileio *fileio, uint32_t *data);
 int fileio_write_u32(struct fileio *fileio, uint32_t data);
 int fileio_size(struct fileio *fileio, size_t *size);
+int fileio_map(struct fileio *fileio, uint8_t **data);
 
 #define ERROR_FILEIO_LOCATION_UNKNOWN			(-1200)
 #define ERROR_FILEIO_NOT_FOUND					(-1201)
@@ -31,6 +31,10 @@
 #include "time_support.h"
 
 #include <stdarg.h>
+#include <signal.h>
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
 
 #ifdef _DEBUG_FREE_SPACE_
 #ifdef HAVE_MALLOC_H
@@ -61,6 +65,186 @@ static const char * const log_strings[6] = {
 
 static int count;
 
+/* Log channels, one for each source directory below src/. A channel can
+ * be given a level that overrides debug_level for its messages. */
+static const char * const log_channel_names[] = {
+	"flash",
+	"helper",
+	"jtag",
+	"pld",
+	"rtos",
+	"rtt",
+	"server",
+	"svf",
+	"target",
+	"transport",
+	"xsvf",
+};
+
+#define LOG_CHANNEL_NONE	(-1)
+
+static int log_channel_levels[ARRAY_SIZE(log_channel_names)];
+static bool log_channel_level_set[ARRAY_SIZE(log_channel_names)];
+bool log_channel_levels_set;
+
+/* __FILE__ strings are constant, so the channel of each can be cached by address */
+#define LOG_CHANNEL_CACHE_SIZE	64
+static struct {
+	const char *file;
+	int channel;
+} log_channel_cache[LOG_CHANNEL_CACHE_SIZE];
+
+static int log_channel_find(const char *file)
+{
+	const char *dir = file, *p;
+	size_t len;
+
+	/* the channel is the directory right below the last "src/" */
+	for (p = strstr(file, "src/"); p; p = strstr(p + 1, "src/"))
+		dir = p + 4;
+
+	p = strchr(dir, '/');
+	if (p == NULL)
+		return LOG_CHANNEL_NONE;
+	len = p - dir;
+
+	for (unsigned int i = 0; i < ARRAY_SIZE(log_channel_names); i++) {
+		if (strlen(log_channel_names[i]) == len
+				&& strncmp(log_channel_names[i], dir, len) == 0)
+			return i;
+	}
+
+	return LOG_CHANNEL_NONE;
+}
+
+static int log_channel_by_name(const char *name)
+{
+	for (unsigned int i = 0; i < ARRAY_SIZE(log_channel_names); i++) {
+		if (strcmp(log_channel_names[i], name) == 0)
+			return i;
+	}
+
+	return LOG_CHANNEL_NONE;
+}
+
+/**
+ * Check whether a message of @a level from source @a file gets logged,
+ * taking the level of its log channel into account.
+ */
+bool log_level_enabled(const char *file, enum log_levels level)
+{
+	if (!log_channel_levels_set)
+		return debug_level >= (int)level;
+
+	unsigned int slot = ((uintptr_t)file >> 3) % LOG_CHANNEL_CACHE_SIZE;
+	if (log_channel_cache[slot].file != file) {
+		log_channel_cache[slot].file = file;
+		log_channel_cache[slot].channel = log_channel_find(file);
+	}
+
+	int channel = log_channel_cache[slot].channel;
+	if (channel != LOG_CHANNEL_NONE && log_channel_level_set[channel])
+		return log_channel_levels[channel] >= (int)level;
+
+	return debug_level >= (int)level;
+}
+
+/* Log text is collected here and written out in batches, so that debug
+ * output from hot paths costs a memory copy instead of a write() per
+ * message. Anything at LOG_LVL_INFO or above is flushed right away. */
+#define LOG_BUFFER_SIZE (64 * 1024)
+static char log_buffer[LOG_BUFFER_SIZE];
+static size_t log_buffer_used;
+/* fileno(log_output), for use from signal handlers */
+static int log_fd = -1;
+
+static void log_write_buffer(void)
+{
+	if (log_buffer_used) {
+		fwrite(log_buffer, 1, log_buffer_used, log_output);
+		log_buffer_used = 0;
+	}
+}
+
+static void log_write(const char *format, ...)
+	__attribute__ ((format (PRINTF_ATTRIBUTE_FORMAT, 1, 2)));
+
+static void log_write(const char *format, ...)
+{
+	va_list ap;
+	int len;
+
+	va_start(ap, format);
+	len = vsnprintf(log_buffer + log_buffer_used,
+			LOG_BUFFER_SIZE - log_buffer_used, format, ap);
+	va_end(ap);
+
+	if (len < 0)
+		return;
+
+	if ((size_t)len < LOG_BUFFER_SIZE - log_buffer_used) {
+		log_buffer_used += len;
+		return;
+	}
+
+	/* didn't fit, make room and try again */
+	log_write_buffer();
+
+	va_start(ap, format);
+	if ((size_t)len < LOG_BUFFER_SIZE)
+		log_buffer_used = vsnprintf(log_buffer, LOG_BUFFER_SIZE, format, ap);
+	else
+		vfprintf(log_output, format, ap);
+	va_end(ap);
+}
+
+/**
+ * Write out any buffered log text. This happens on its own for messages
+ * the user is meant to see, but must be called before the process goes
+ * idle or exits so that pending debug output isn't held back.
+ */
+void log_flush(void)
+{
+	if (log_output == NULL)
+		return;
+
+	log_write_buffer();
+	fflush(log_output);
+}
+
+/**
+ * Write out buffered log text from a fatal signal handler, where stdio
+ * can't be used. Log files are unbuffered at the stdio level (see
+ * handle_log_output_command()), so this is all that would be lost.
+ */
+void log_emergency_flush(void)
+{
+	const char *p = log_buffer;
+	size_t left = log_buffer_used;
+
+	if (log_fd < 0)
+		return;
+
+	while (left) {
+		ssize_t n = write(log_fd, p, left);
+		if (n <= 0)
+			break;
+		p += n;
+		left -= n;
+	}
+	log_buffer_used = 0;
+}
+
+/* SIGSEGV and friends skip atexit(), the log leading up to them matters */
+static void log_fatal_signal(int sig)
+{
+	log_emergency_flush();
+
+	/* bring back default system handler and let it finish */
+	signal(sig, SIG_DFL);
+	raise(sig);
+}
+
 /* forward the log to the listeners */
 static void log_forward(const char *file, unsigned line, const char *function, const char *string)
 {
@@ -93,8 +277,8 @@ static void log_puts(enum log_levels level,
 	char *f;
 	if (level == LOG_LVL_OUTPUT) {
 		/* do not prepend any headers, just print out what we were given and return */
-		fputs(string, log_output);
-		fflush(log_output);
+		log_write("%s", string);
+		log_flush();
 		return;
 	}
 
@@ -110,7 +294,7 @@ static void log_puts(enum log_levels level,
 			struct mallinfo info;
 			info = mallinfo();
 #endif
-			fprintf(log_output, "%s%d %" PRId64 " %s:%d %s()"
+			log_write("%s%d %" PRId64 " %s:%d %s()"
 #ifdef _DEBUG_FREE_SPACE_
 				" %d"
 #endif
@@ -122,7 +306,7 @@ static void log_puts(enum log_levels level,
 		} else {
 			/* if we are using gdb through pipes then we do not want any output
 			 * to the pipe otherwise we get repeated strings */
-			fprintf(log_output, "%s%s",
+			log_write("%s%s",
 				(level > LOG_LVL_USER) ? log_strings[level + 1] : "", string);
 		}
 	} else {
@@ -130,7 +314,8 @@ static void log_puts(enum log_levels level,
 		 *nothing. */
 	}
 
-	fflush(log_output);
+	if (level <= LOG_LVL_INFO)
+		log_flush();
 
 	/* Never forward LOG_LVL_DEBUG, too verbose and they can be found in the log if need be */
 	if (level <= LOG_LVL_INFO)
@@ -148,7 +333,7 @@ void log_printf(enum log_levels level,
 	va_list ap;
 
 	count++;
-	if (level > debug_level)
+	if (!log_level_enabled(file, level))
 		return;
 
 	va_start(ap, format);
@@ -169,7 +354,7 @@ void log_vprintf_lf(enum log_levels level, const char *file, unsigned line,
 
 	count++;
 
-	if (level > debug_level)
+	if (!log_level_enabled(file, level))
 		return;
 
 	tmp = alloc_vprintf(format, args);
@@ -200,20 +385,59 @@ void log_printf_lf(enum log_levels level,
 	va_end(ap);
 }
 
+static COMMAND_HELPER(log_parse_level, const char *arg, int *level)
+{
+	COMMAND_PARSE_NUMBER(int, arg, *level);
+	if ((*level > LOG_LVL_DEBUG_IO) || (*level < LOG_LVL_SILENT)) {
+		LOG_ERROR("level must be between %d and %d", LOG_LVL_SILENT, LOG_LVL_DEBUG_IO);
+		return ERROR_COMMAND_SYNTAX_ERROR;
+	}
+
+	return ERROR_OK;
+}
+
 COMMAND_HANDLER(handle_debug_level_command)
 {
+	int retval;
+
 	if (CMD_ARGC == 1) {
 		int new_level;
-		COMMAND_PARSE_NUMBER(int, CMD_ARGV[0], new_level);
-		if ((new_level > LOG_LVL_DEBUG_IO) || (new_level < LOG_LVL_SILENT)) {
-			LOG_ERROR("level must be between %d and %d", LOG_LVL_SILENT, LOG_LVL_DEBUG_IO);
-			return ERROR_COMMAND_SYNTAX_ERROR;
-		}
+		retval = CALL_COMMAND_HANDLER(log_parse_level, CMD_ARGV[0], &new_level);
+		if (retval != ERROR_OK)
+			return retval;
 		debug_level = new_level;
-	} else if (CMD_ARGC > 1)
+	} else if (CMD_ARGC % 2)
 		return ERROR_COMMAND_SYNTAX_ERROR;
 
+	/* pairs of channel and level, "default" drops the channel's own level */
+	for (unsigned int i = 0; CMD_ARGC > 1 && i < CMD_ARGC; i += 2) {
+		int channel = log_channel_by_name(CMD_ARGV[i]);
+		if (channel == LOG_CHANNEL_NONE) {
+			command_print(CMD_CTX, "unknown log channel '%s'", CMD_ARGV[i]);
+			return ERROR_COMMAND_SYNTAX_ERROR;
+		}
+
+		if (strcmp(CMD_ARGV[i + 1], "default") == 0) {
+			log_channel_level_set[channel] = false;
+		} else {
+			retval = CALL_COMMAND_HANDLER(log_parse_level, CMD_ARGV[i + 1],
+					&log_channel_levels[channel]);
+			if (retval != ERROR_OK)
+				return retval;
+			log_channel_level_set[channel] = true;
+		}
+	}
+
+	log_channel_levels_set = false;
+	for (unsigned int i = 0; i < ARRAY_SIZE(log_channel_names); i++)
+		log_channel_levels_set |= log_channel_level_set[i];
+
 	command_print(CMD_CTX, "debug_level: %i", debug_level);
+	for (unsigned int i = 0; i < ARRAY_SIZE(log_channel_names); i++) {
+		if (log_channel_level_set[i])
+			command_print(CMD_CTX, "debug_level %s: %i",
+				log_channel_names[i], log_channel_levels[i]);
+	}
 
 	return ERROR_OK;
 }
@@ -226,11 +450,15 @@ COMMAND_HANDLER(handle_log_output_command)
 			LOG_ERROR("failed to open output log '%s'", CMD_ARGV[0]);
 			return ERROR_FAIL;
 		}
+		log_flush();
 		if (log_output != stderr && log_output != NULL) {
 			/* Close previous log file, if it was open and wasn't stderr. */
 			fclose(log_output);
 		}
+		/* log.c buffers on its own, keep nothing in stdio a crash could lose */
+		setvbuf(file, NULL, _IONBF, 0);
 		log_output = file;
+		log_fd = fileno(file);
 	}
 
 	return ERROR_OK;
@@ -251,8 +479,11 @@ static struct command_registration log_command_handlers[] = {
 		.help = "Sets the verbosity level of debugging output. "
 			"0 shows errors only; 1 adds warnings; "
 			"2 (default) adds other info; 3 adds debugging; "
-			"4 adds extra verbose debugging.",
-		.usage = "number",
+			"4 adds extra verbose debugging. "
+			"Levels given for a log channel (flash, helper, jtag, pld, "
+			"rtos, rtt, server, svf, target, transport, xsvf) override "
+			"it for messages from that part of OpenOCD.",
+		.usage = "[number | (channel (number|'default'))...]",
 	},
 	COMMAND_REGISTRATION_DONE
 };
@@ -281,13 +512,30 @@ void log_init(void)
 
 	if (log_output == NULL)
 		log_output = stderr;
+	log_fd = fileno(log_output);
+
+	/* don't lose buffered debug output on exit() or a crash */
+	static bool log_flush_registered;
+	if (!log_flush_registered) {
+		atexit(log_flush);
+		signal(SIGSEGV, log_fatal_signal);
+		signal(SIGILL, log_fatal_signal);
+		signal(SIGFPE, log_fatal_signal);
+		signal(SIGABRT, log_fatal_signal);
+#ifdef SIGBUS
+		signal(SIGBUS, log_fatal_signal);
+#endif
+		log_flush_registered = true;
+	}
 
 	start = last_time = timeval_ms();
 }
 
 int set_log_output(struct command_context *cmd_ctx, FILE *output)
 {
+	log_flush();
 	log_output = output;
+	log_fd = output ? fileno(output) : -1;
 	return ERROR_OK;
 }
 
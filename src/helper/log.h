@@ -72,6 +72,8 @@ __attribute__ ((format (PRINTF_ATTRIBUTE_FORMAT, 5, 6)));
  * Initialize logging module.  Call during program startup.
  */
 void log_init(void);
+void log_flush(void);
+void log_emergency_flush(void);
 int set_log_output(struct command_context *cmd_ctx, FILE *output);
 
 int log_register_commands(struct command_context *cmd_ctx);
@@ -99,22 +101,41 @@ char *alloc_printf(const char *fmt, ...);
 
 extern int debug_level;
 
+/* Set once any log channel got its own level with "debug_level <channel> <n>" */
+extern bool log_channel_levels_set;
+
+bool log_level_enabled(const char *file, enum log_levels level);
+
 /* Avoid fn call and building parameter list if we're not outputting the information.
- * Matters on feeble CPUs for DEBUG/INFO statements that are involved frequently */
+ * Matters on feeble CPUs for DEBUG/INFO statements that are involved frequently.
+ * Only when some channel has a level of its own does the source file have to
+ * be looked at. */
 
-#define LOG_LEVEL_IS(FOO)  ((debug_level) >= (FOO))
+#define LOG_LEVEL_IS(FOO) \
+	(!log_channel_levels_set ? ((debug_level) >= (FOO)) : log_level_enabled(__FILE__, (FOO)))
 
+#ifdef _STRIP_DEBUG_IO_LOG_
+/* keep the arguments type checked, but let the compiler drop the call */
+#define LOG_DEBUG_IO(expr ...) \
+	do { \
+		if (0) \
+			log_printf_lf(LOG_LVL_DEBUG, \
+				__FILE__, __LINE__, __func__, \
+				expr); \
+	} while (0)
+#else
 #define LOG_DEBUG_IO(expr ...) \
 	do { \
-		if (debug_level >= LOG_LVL_DEBUG_IO) \
+		if (LOG_LEVEL_IS(LOG_LVL_DEBUG_IO)) \
 			log_printf_lf(LOG_LVL_DEBUG, \
 				__FILE__, __LINE__, __func__, \
 				expr); \
 	} while (0)
+#endif
 
 #define LOG_DEBUG(expr ...) \
 	do { \
-		if (debug_level >= LOG_LVL_DEBUG) \
+		if (LOG_LEVEL_IS(LOG_LVL_DEBUG)) \
 			log_printf_lf(LOG_LVL_DEBUG, \
 				__FILE__, __LINE__, __func__, \
 				expr); \
@@ -0,0 +1,438 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by the OpenOCD developers                          *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "perf.h"
+#include "log.h"
+
+bool perf_enabled;
+bool perf_tracing;
+
+/* every stat that recorded something, in order of first use */
+static struct perf_stat *perf_stats;
+
+#define PERF_TRACE_DEFAULT_EVENTS	65536
+#define PERF_TRACE_DETAIL_SIZE		32
+
+struct perf_trace_event {
+	const char *name;
+	char detail[PERF_TRACE_DETAIL_SIZE];
+	int64_t start;
+	int64_t duration;
+};
+
+/* ring of the most recent trace events, oldest at perf_trace_next once full */
+static struct perf_trace_event *perf_trace_events;
+static size_t perf_trace_size;
+static size_t perf_trace_next;
+static bool perf_trace_wrapped;
+
+static void perf_trace(const char *name, const char *detail, int64_t start, int64_t duration)
+{
+	struct perf_trace_event *event = &perf_trace_events[perf_trace_next];
+
+	event->name = name;
+	if (detail) {
+		strncpy(event->detail, detail, PERF_TRACE_DETAIL_SIZE - 1);
+		event->detail[PERF_TRACE_DETAIL_SIZE - 1] = '\0';
+	} else
+		event->detail[0] = '\0';
+	event->start = start;
+	event->duration = duration;
+
+	if (++perf_trace_next == perf_trace_size) {
+		perf_trace_next = 0;
+		perf_trace_wrapped = true;
+	}
+}
+
+static void perf_register(struct perf_stat *stat)
+{
+	struct perf_stat **p;
+
+	if (stat->registered)
+		return;
+
+	for (p = &perf_stats; *p; p = &(*p)->next)
+		;
+	*p = stat;
+	stat->next = NULL;
+	stat->registered = true;
+}
+
+static unsigned int perf_bucket(int64_t us)
+{
+	unsigned int bucket = 0;
+
+	while (us > 0 && bucket < PERF_HISTOGRAM_BUCKETS - 1) {
+		us >>= 1;
+		bucket++;
+	}
+
+	return bucket;
+}
+
+/**
+ * Account for an operation started with perf_start().
+ *
+ * @param stat The statistics of the instrumented spot.
+ * @param detail What the operation was about, shown in trace events; may
+ * be NULL.
+ * @param start Value returned by perf_start(), non-zero.
+ * @param items Layer specific units of work done by the operation.
+ * @param bytes Payload moved by the operation.
+ * @param retval The operation's result, anything but ERROR_OK counts as
+ * an error.
+ */
+void perf_record(struct perf_stat *stat, const char *detail, int64_t start,
+		uint64_t items, uint64_t bytes, int retval)
+{
+	int64_t elapsed = monotonic_us() - start;
+	if (elapsed < 0)
+		elapsed = 0;
+
+	if (perf_tracing)
+		perf_trace(stat->name, detail, start, elapsed);
+
+	if (!perf_enabled)
+		return;
+
+	perf_register(stat);
+
+	stat->count++;
+	if (retval != ERROR_OK)
+		stat->errors++;
+	stat->items += items;
+	stat->bytes += bytes;
+	stat->total_us += elapsed;
+	if (elapsed > stat->max_us)
+		stat->max_us = elapsed;
+	stat->histogram[perf_bucket(elapsed)]++;
+}
+
+/** Count an event that has no duration of its own, e.g. a DAP WAIT. */
+void perf_count(struct perf_stat *stat, uint64_t items)
+{
+	if (!perf_enabled)
+		return;
+
+	perf_register(stat);
+
+	stat->count++;
+	stat->items += items;
+}
+
+/* upper bound of the histogram bucket holding the given percentile */
+static int64_t perf_percentile(const struct perf_stat *stat, unsigned int percent)
+{
+	uint64_t threshold = (stat->count * percent + 99) / 100;
+	uint64_t seen = 0;
+
+	if (!stat->count)
+		return 0;
+
+	for (unsigned int i = 0; i < PERF_HISTOGRAM_BUCKETS; i++) {
+		seen += stat->histogram[i];
+		if (seen >= threshold)
+			return MIN(i ? (int64_t)1 << i : 1, stat->max_us);
+	}
+
+	return stat->max_us;
+}
+
+static void perf_reset(void)
+{
+	struct perf_stat *stat, *next;
+
+	for (stat = perf_stats; stat; stat = next) {
+		next = stat->next;
+
+		const char *name = stat->name;
+		memset(stat, 0, sizeof(*stat));
+		stat->name = name;
+	}
+	perf_stats = NULL;
+}
+
+COMMAND_HANDLER(handle_perf_enable_command)
+{
+	if (CMD_ARGC != 0)
+		return ERROR_COMMAND_SYNTAX_ERROR;
+
+	perf_enabled = true;
+	return ERROR_OK;
+}
+
+COMMAND_HANDLER(handle_perf_disable_command)
+{
+	if (CMD_ARGC != 0)
+		return ERROR_COMMAND_SYNTAX_ERROR;
+
+	perf_enabled = false;
+	return ERROR_OK;
+}
+
+COMMAND_HANDLER(handle_perf_reset_command)
+{
+	if (CMD_ARGC != 0)
+		return ERROR_COMMAND_SYNTAX_ERROR;
+
+	perf_reset();
+	return ERROR_OK;
+}
+
+static void perf_print_json(struct command_context *cmd_ctx)
+{
+	struct perf_stat *stat;
+
+	command_print_sameline(cmd_ctx, "{\"enabled\":%s,\"stats\":[",
+		perf_enabled ? "true" : "false");
+
+	for (stat = perf_stats; stat; stat = stat->next) {
+		command_print_sameline(cmd_ctx,
+			"%s{\"name\":\"%s\",\"count\":%" PRIu64 ",\"errors\":%" PRIu64
+			",\"items\":%" PRIu64 ",\"bytes\":%" PRIu64
+			",\"total_us\":%" PRId64 ",\"max_us\":%" PRId64
+			",\"p50_us\":%" PRId64 ",\"p90_us\":%" PRId64 ",\"p99_us\":%" PRId64
+			",\"histogram\":[",
+			(stat == perf_stats) ? "" : ",",
+			stat->name, stat->count, stat->errors, stat->items, stat->bytes,
+			stat->total_us, stat->max_us, perf_percentile(stat, 50),
+			perf_percentile(stat, 90), perf_percentile(stat, 99));
+
+		for (unsigned int i = 0; i < PERF_HISTOGRAM_BUCKETS; i++)
+			command_print_sameline(cmd_ctx, "%s%" PRIu64, i ? "," : "", stat->histogram[i]);
+
+		command_print_sameline(cmd_ctx, "]}");
+	}
+
+	command_print(cmd_ctx, "]}");
+}
+
+COMMAND_HANDLER(handle_perf_stats_command)
+{
+	struct perf_stat *stat;
+
+	if (CMD_ARGC == 1 && strcmp(CMD_ARGV[0], "json") == 0) {
+		perf_print_json(CMD_CTX);
+		return ERROR_OK;
+	} else if (CMD_ARGC != 0)
+		return ERROR_COMMAND_SYNTAX_ERROR;
+
+	if (!perf_enabled && !perf_stats) {
+		command_print(CMD_CTX, "performance statistics are disabled, see 'perf enable'");
+		return ERROR_OK;
+	}
+
+	command_print(CMD_CTX, "%-20s %10s %6s %10s %12s %10s %8s %8s %8s %8s",
+		"name", "count", "errors", "items", "bytes",
+		"total ms", "avg us", "p50 us", "p99 us", "max us");
+
+	for (stat = perf_stats; stat; stat = stat->next) {
+		command_print(CMD_CTX, "%-20s %10" PRIu64 " %6" PRIu64 " %10" PRIu64 " %12" PRIu64
+			" %10" PRId64 " %8" PRId64 " %8" PRId64 " %8" PRId64 " %8" PRId64,
+			stat->name, stat->count, stat->errors, stat->items, stat->bytes,
+			stat->total_us / 1000,
+			stat->count ? stat->total_us / (int64_t)stat->count : 0,
+			perf_percentile(stat, 50), perf_percentile(stat, 99), stat->max_us);
+	}
+
+	return ERROR_OK;
+}
+
+COMMAND_HANDLER(handle_perf_trace_start_command)
+{
+	unsigned int size = PERF_TRACE_DEFAULT_EVENTS;
+
+	if (CMD_ARGC > 1)
+		return ERROR_COMMAND_SYNTAX_ERROR;
+	if (CMD_ARGC == 1) {
+		COMMAND_PARSE_NUMBER(uint, CMD_ARGV[0], size);
+		if (size == 0)
+			return ERROR_COMMAND_SYNTAX_ERROR;
+	}
+
+	perf_tracing = false;
+
+	if (size != perf_trace_size) {
+		struct perf_trace_event *events = realloc(perf_trace_events,
+				size * sizeof(*events));
+		if (events == NULL) {
+			LOG_ERROR("not enough memory for %u trace events", size);
+			return ERROR_FAIL;
+		}
+		perf_trace_events = events;
+		perf_trace_size = size;
+	}
+
+	perf_trace_next = 0;
+	perf_trace_wrapped = false;
+	perf_tracing = true;
+
+	return ERROR_OK;
+}
+
+COMMAND_HANDLER(handle_perf_trace_stop_command)
+{
+	if (CMD_ARGC != 0)
+		return ERROR_COMMAND_SYNTAX_ERROR;
+
+	perf_tracing = false;
+	return ERROR_OK;
+}
+
+/* characters that can't go into a JSON string as they are */
+static void perf_json_string(FILE *file, const char *string)
+{
+	for (; *string; string++) {
+		if (*string == '"' || *string == '\\')
+			fprintf(file, "\\%c", *string);
+		else if ((unsigned char)*string < 0x20)
+			fprintf(file, "\\u%04x", *string);
+		else
+			fputc(*string, file);
+	}
+}
+
+COMMAND_HANDLER(handle_perf_trace_dump_command)
+{
+	if (CMD_ARGC != 1)
+		return ERROR_COMMAND_SYNTAX_ERROR;
+
+	if (perf_trace_events == NULL) {
+		command_print(CMD_CTX, "no trace recorded, see 'perf trace start'");
+		return ERROR_FAIL;
+	}
+
+	FILE *file = fopen(CMD_ARGV[0], "w");
+	if (file == NULL) {
+		LOG_ERROR("couldn't open %s: %s", CMD_ARGV[0], strerror(errno));
+		return ERROR_FAIL;
+	}
+
+	size_t first = perf_trace_wrapped ? perf_trace_next : 0;
+	size_t count = perf_trace_wrapped ? perf_trace_size : perf_trace_next;
+
+	/* Chrome trace event format, complete ("X") events on a single thread */
+	fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	for (size_t i = 0; i < count; i++) {
+		const struct perf_trace_event *event =
+			&perf_trace_events[(first + i) % perf_trace_size];
+		const char *dot = strchr(event->name, '.');
+		int category_len = dot ? (int)(dot - event->name) : (int)strlen(event->name);
+
+		fprintf(file, "%s{\"name\":\"", i ? ",\n" : "");
+		perf_json_string(file, event->detail[0] ? event->detail : event->name);
+		fprintf(file, "\",\"cat\":\"%.*s\",\"ph\":\"X\",\"ts\":%" PRId64
+			",\"dur\":%" PRId64 ",\"pid\":1,\"tid\":1,\"args\":{\"op\":\"%s\"}}",
+			category_len, event->name, event->start, event->duration, event->name);
+	}
+	fprintf(file, "\n]}\n");
+
+	if (fclose(file) != 0) {
+		LOG_ERROR("couldn't write %s: %s", CMD_ARGV[0], strerror(errno));
+		return ERROR_FAIL;
+	}
+
+	command_print(CMD_CTX, "%zu trace events written to %s", count, CMD_ARGV[0]);
+
+	return ERROR_OK;
+}
+
+static const struct command_registration perf_trace_subcommand_handlers[] = {
+	{
+		.name = "start",
+		.handler = handle_perf_trace_start_command,
+		.mode = COMMAND_ANY,
+		.help = "start recording trace events, keeping the most recent ones",
+		.usage = "[max_events]",
+	},
+	{
+		.name = "stop",
+		.handler = handle_perf_trace_stop_command,
+		.mode = COMMAND_ANY,
+		.help = "stop recording trace events",
+		.usage = "",
+	},
+	{
+		.name = "dump",
+		.handler = handle_perf_trace_dump_command,
+		.mode = COMMAND_ANY,
+		.help = "write the recorded events as a Chrome trace (JSON) file",
+		.usage = "filename",
+	},
+	COMMAND_REGISTRATION_DONE
+};
+
+static const struct command_registration perf_subcommand_handlers[] = {
+	{
+		.name = "enable",
+		.handler = handle_perf_enable_command,
+		.mode = COMMAND_ANY,
+		.help = "start collecting performance statistics",
+		.usage = "",
+	},
+	{
+		.name = "disable",
+		.handler = handle_perf_disable_command,
+		.mode = COMMAND_ANY,
+		.help = "stop collecting performance statistics",
+		.usage = "",
+	},
+	{
+		.name = "reset",
+		.handler = handle_perf_reset_command,
+		.mode = COMMAND_ANY,
+		.help = "clear all performance statistics",
+		.usage = "",
+	},
+	{
+		.name = "stats",
+		.handler = handle_perf_stats_command,
+		.mode = COMMAND_ANY,
+		.help = "show performance statistics, as a table or as JSON",
+		.usage = "['json']",
+	},
+	{
+		.name = "trace",
+		.mode = COMMAND_ANY,
+		.help = "timeline of operations for chrome://tracing or Perfetto",
+		.usage = "",
+		.chain = perf_trace_subcommand_handlers,
+	},
+	COMMAND_REGISTRATION_DONE
+};
+
+static const struct command_registration perf_command_handlers[] = {
+	{
+		.name = "perf",
+		.mode = COMMAND_ANY,
+		.help = "performance statistics of the JTAG, DAP, target, flash "
+			"and GDB layers",
+		.usage = "",
+		.chain = perf_subcommand_handlers,
+	},
+	COMMAND_REGISTRATION_DONE
+};
+
+int perf_register_commands(struct command_context *cmd_ctx)
+{
+	return register_commands(cmd_ctx, NULL, perf_command_handlers);
+}
@@ -0,0 +1,94 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by the OpenOCD developers                          *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#ifndef OPENOCD_HELPER_PERF_H
+#define OPENOCD_HELPER_PERF_H
+
+#include <helper/command.h>
+#include <helper/time_support.h>
+
+/**
+ * @file
+ * Counters and latency histograms for the layers a debug session's time
+ * is spent in (JTAG queue, DAP, target memory, flash, GDB packets).
+ *
+ * Each instrumented spot owns a struct perf_stat, which is linked into the
+ * list reported by "perf stats" the first time it records anything. While
+ * collection is disabled (the default) perf_start() is a single test of
+ * a global flag.
+ *
+ * When tracing is on, every operation is also recorded as a begin/duration
+ * event in a ring buffer that "perf trace dump" writes out in the Chrome
+ * trace event format.
+ */
+
+/* histogram bucket n counts operations taking [2^(n-1), 2^n) microseconds */
+#define PERF_HISTOGRAM_BUCKETS	32
+
+struct perf_stat {
+	/** Name shown in reports, "layer.operation" */
+	const char *name;
+	/** Completed operations */
+	uint64_t count;
+	/** Operations that returned an error */
+	uint64_t errors;
+	/** Layer specific unit of work, e.g. queued commands or packets */
+	uint64_t items;
+	/** Payload moved by the operations */
+	uint64_t bytes;
+	/** Sum and maximum of the operation times */
+	int64_t total_us;
+	int64_t max_us;
+	uint64_t histogram[PERF_HISTOGRAM_BUCKETS];
+	struct perf_stat *next;
+	bool registered;
+};
+
+#define PERF_STAT_INIT(stat_name) { .name = (stat_name) }
+
+extern bool perf_enabled;
+extern bool perf_tracing;
+
+/** @returns the start time of an operation, or 0 when not collecting */
+static inline int64_t perf_start(void)
+{
+	return (perf_enabled || perf_tracing) ? monotonic_us() : 0;
+}
+
+void perf_record(struct perf_stat *stat, const char *detail, int64_t start,
+		uint64_t items, uint64_t bytes, int retval);
+
+/** Account for an operation started with perf_start(), see perf_record() */
+static inline void perf_end(struct perf_stat *stat, int64_t start, uint64_t items,
+		uint64_t bytes, int retval)
+{
+	if (start)
+		perf_record(stat, NULL, start, items, bytes, retval);
+}
+
+/** As perf_end(), naming the operation in trace events, e.g. a command */
+static inline void perf_end_detail(struct perf_stat *stat, const char *detail,
+		int64_t start, uint64_t items, uint64_t bytes, int retval)
+{
+	if (start)
+		perf_record(stat, detail, start, items, bytes, retval);
+}
+void perf_count(struct perf_stat *stat, uint64_t items);
+
+int perf_register_commands(struct command_context *cmd_ctx);
+
+#endif /* OPENOCD_HELPER_PERF_H */
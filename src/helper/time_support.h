@@ -42,6 +42,10 @@ int timeval_compare(const struct timeval *x, const struct timeval *y);
 
 /** @returns gettimeofday() timeval as 64-bit in ms */
 int64_t timeval_ms(void);
+/** @returns gettimeofday() timeval as 64-bit in us */
+int64_t timeval_us(void);
+/** @returns a monotonic clock in us, falls back to timeval_us() */
+int64_t monotonic_us(void);
 
 struct duration {
 	struct timeval start;
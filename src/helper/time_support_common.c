@@ -28,6 +28,10 @@
 
 #include "time_support.h"
 
+#ifdef HAVE_CLOCK_GETTIME
+#include <time.h>
+#endif
+
 /* simple and low overhead fetching of ms counter. Use only
  * the difference between ms counters returned from this fn.
  */
@@ -39,3 +43,25 @@ int64_t timeval_ms(void)
 		return retval;
 	return (int64_t)now.tv_sec * 1000 + now.tv_usec / 1000;
 }
+
+/* as timeval_ms(), with microsecond resolution */
+int64_t timeval_us(void)
+{
+	struct timeval now;
+	int retval = gettimeofday(&now, NULL);
+	if (retval < 0)
+		return retval;
+	return (int64_t)now.tv_sec * 1000000 + now.tv_usec;
+}
+
+/* microseconds on a clock that is not stepped with the wall clock,
+ * for scheduling; only differences are meaningful */
+int64_t monotonic_us(void)
+{
+#if defined(HAVE_CLOCK_GETTIME) && defined(CLOCK_MONOTONIC)
+	struct timespec now;
+	if (clock_gettime(CLOCK_MONOTONIC, &now) == 0)
+		return (int64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+#endif
+	return timeval_us();
+}
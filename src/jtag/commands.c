@@ -31,17 +31,34 @@
 #endif
 
 #include <jtag/jtag.h>
+#include <jtag/interface.h>
 #include "commands.h"
 
 struct cmd_queue_page {
 	struct cmd_queue_page *next;
 	void *address;
 	size_t used;
+	size_t size;
+	/** number of consecutive queue flushes that left this page unused */
+	unsigned idle_flushes;
 };
 
 #define CMD_QUEUE_PAGE_SIZE (1024 * 1024)
+
+/**
+ * Pages are kept across queue flushes so that the common case of a short
+ * queue does not pay for a malloc()/free() of a whole page (and the OS
+ * zeroing it) on every jtag_execute_queue(). A page that was not needed
+ * by this many consecutive flushes is released again, so memory use
+ * follows the high-water mark of recent flushes instead of the largest
+ * queue ever built.
+ */
+#define CMD_QUEUE_PAGE_IDLE_LIMIT 64
+
 static struct cmd_queue_page *cmd_queue_pages;
 static struct cmd_queue_page *cmd_queue_pages_tail;
+/** page currently being filled; pages before it are full or skipped */
+static struct cmd_queue_page *cmd_queue_pages_current;
 
 struct jtag_command *jtag_command_queue;
 static struct jtag_command **next_command_pointer = &jtag_command_queue;
@@ -62,8 +79,6 @@ void jtag_queue_command(struct jtag_command *cmd)
 
 void *cmd_queue_alloc(size_t size)
 {
-	struct cmd_queue_page **p_page = &cmd_queue_pages;
-	int offset;
 	uint8_t *t;
 
 	/*
@@ -98,30 +113,80 @@ void *cmd_queue_alloc(size_t size)
 	size = (size + ALIGN_SIZE - 1) & (~(ALIGN_SIZE - 1));
 	/* Done... */
 
-	if (*p_page) {
-		p_page = &cmd_queue_pages_tail;
-		if (CMD_QUEUE_PAGE_SIZE - (*p_page)->used < size)
-			p_page = &((*p_page)->next);
-	}
+	struct cmd_queue_page *page = cmd_queue_pages_current;
+	if (!page)
+		page = cmd_queue_pages;
+
+	/* skip over pages (recycled from earlier flushes) lacking room */
+	while (page && page->size - page->used < size)
+		page = page->next;
 
-	if (!*p_page) {
-		*p_page = malloc(sizeof(struct cmd_queue_page));
-		(*p_page)->used = 0;
-		size_t alloc_size = (size < CMD_QUEUE_PAGE_SIZE) ?
-					CMD_QUEUE_PAGE_SIZE : size;
-		(*p_page)->address = malloc(alloc_size);
-		(*p_page)->next = NULL;
-		cmd_queue_pages_tail = *p_page;
+	if (!page) {
+		page = malloc(sizeof(struct cmd_queue_page));
+		if (!page)
+			return NULL;
+		page->size = (size < CMD_QUEUE_PAGE_SIZE) ? CMD_QUEUE_PAGE_SIZE : size;
+		page->address = malloc(page->size);
+		if (!page->address) {
+			free(page);
+			return NULL;
+		}
+		page->used = 0;
+		page->idle_flushes = 0;
+		page->next = NULL;
+
+		if (cmd_queue_pages_tail)
+			cmd_queue_pages_tail->next = page;
+		else
+			cmd_queue_pages = page;
+		cmd_queue_pages_tail = page;
 	}
 
-	offset = (*p_page)->used;
-	(*p_page)->used += size;
+	cmd_queue_pages_current = page;
 
-	t = (*p_page)->address;
-	return t + offset;
+	t = page->address;
+	t += page->used;
+	page->used += size;
+
+	return t;
 }
 
-static void cmd_queue_free(void)
+/**
+ * Make all pages available again for the next queue, releasing those
+ * that have not been needed for CMD_QUEUE_PAGE_IDLE_LIMIT flushes.
+ * The first page is always kept.
+ */
+static void cmd_queue_recycle(void)
+{
+	struct cmd_queue_page **p_page = &cmd_queue_pages;
+	struct cmd_queue_page *prev = NULL;
+
+	while (*p_page) {
+		struct cmd_queue_page *page = *p_page;
+
+		if (page->used)
+			page->idle_flushes = 0;
+		else
+			page->idle_flushes++;
+		page->used = 0;
+
+		if (page != cmd_queue_pages &&
+				page->idle_flushes >= CMD_QUEUE_PAGE_IDLE_LIMIT) {
+			*p_page = page->next;
+			free(page->address);
+			free(page);
+			continue;
+		}
+
+		prev = page;
+		p_page = &page->next;
+	}
+
+	cmd_queue_pages_tail = prev;
+	cmd_queue_pages_current = cmd_queue_pages;
+}
+
+void cmd_queue_free(void)
 {
 	struct cmd_queue_page *page = cmd_queue_pages;
 
@@ -134,16 +199,178 @@ static void cmd_queue_free(void)
 
 	cmd_queue_pages = NULL;
 	cmd_queue_pages_tail = NULL;
+	cmd_queue_pages_current = NULL;
 }
 
 void jtag_command_queue_reset(void)
 {
-	cmd_queue_free();
+	cmd_queue_recycle();
 
 	jtag_command_queue = NULL;
 	next_command_pointer = &jtag_command_queue;
 }
 
+static struct jtag_queue_optimizer_stats jtag_queue_optimizer_stats;
+
+const struct jtag_queue_optimizer_stats *jtag_command_queue_optimizer_stats(void)
+{
+	return &jtag_queue_optimizer_stats;
+}
+
+/** @returns true if both scans shift exactly the same bits out. */
+static bool jtag_scan_out_equal(const struct scan_command *a, const struct scan_command *b)
+{
+	if (a->num_fields != b->num_fields)
+		return false;
+
+	for (int i = 0; i < a->num_fields; i++) {
+		const struct scan_field *fa = &a->fields[i], *fb = &b->fields[i];
+
+		if (fa->num_bits != fb->num_bits)
+			return false;
+		if (!fa->out_value || !fb->out_value)
+			return false;
+		if (buf_cmp(fa->out_value, fb->out_value, fa->num_bits))
+			return false;
+	}
+
+	return true;
+}
+
+static bool jtag_scan_captures(const struct scan_command *scan)
+{
+	for (int i = 0; i < scan->num_fields; i++) {
+		if (scan->fields[i].in_value)
+			return true;
+	}
+	return false;
+}
+
+/**
+ * Concatenate the fields of @a second onto @a first. Only valid when
+ * @a first ends in the pause state of the same register, so that the TAP
+ * never passes through an update state between the two scans.
+ */
+static void jtag_scan_merge(struct scan_command *first, const struct scan_command *second)
+{
+	int num_fields = first->num_fields + second->num_fields;
+	struct scan_field *fields = cmd_queue_alloc(num_fields * sizeof(struct scan_field));
+
+	memcpy(fields, first->fields, first->num_fields * sizeof(struct scan_field));
+	memcpy(fields + first->num_fields, second->fields,
+			second->num_fields * sizeof(struct scan_field));
+
+	first->fields = fields;
+	first->num_fields = num_fields;
+	first->end_state = second->end_state;
+}
+
+/**
+ * Rewrite the queued commands so that they need fewer TCK cycles while
+ * leaving the TAPs in exactly the same state:
+ *
+ * - an IR scan that would shift the same bits as the last IR scan in this
+ *   queue is dropped when nothing captures its output, nothing in between
+ *   could have changed the IR and it would end in the state the TAP is
+ *   already in;
+ * - a runtest ending in RUN/IDLE followed by another runtest is folded
+ *   into a single runtest;
+ * - a scan ending in DRPAUSE (IRPAUSE) followed by another DR (IR) scan is
+ *   merged into one longer scan.
+ *
+ * Re-issuing an instruction can have side effects on some TAPs (e.g.
+ * instructions acting on Update-IR), which is why this pass is optional.
+ */
+void jtag_command_queue_optimize(void)
+{
+	struct jtag_command **p_cmd = &jtag_command_queue;
+	struct jtag_command *prev = NULL;
+	/* last IR scan known to hold the current IR contents */
+	const struct scan_command *last_ir = NULL;
+	/* TAP state after the previous command, when known */
+	tap_state_t state = TAP_INVALID;
+
+	while (*p_cmd) {
+		struct jtag_command *cmd = *p_cmd;
+		bool drop = false;
+
+		switch (cmd->type) {
+		case JTAG_SCAN: {
+			struct scan_command *scan = cmd->cmd.scan;
+
+			if (scan->ir_scan && last_ir && state == scan->end_state &&
+					!jtag_scan_captures(scan) && jtag_scan_out_equal(scan, last_ir)) {
+				jtag_queue_optimizer_stats.ir_scans_elided++;
+				jtag_queue_optimizer_stats.bits_saved += jtag_scan_size(scan) +
+					tap_get_tms_path_len(state, TAP_IRSHIFT) +
+					tap_get_tms_path_len(TAP_IRSHIFT, state);
+				drop = true;
+				break;
+			}
+
+			if (prev && prev->type == JTAG_SCAN &&
+					prev->cmd.scan->ir_scan == scan->ir_scan &&
+					prev->cmd.scan->end_state == (scan->ir_scan ? TAP_IRPAUSE : TAP_DRPAUSE)) {
+				tap_state_t shift = scan->ir_scan ? TAP_IRSHIFT : TAP_DRSHIFT;
+
+				jtag_queue_optimizer_stats.scans_merged++;
+				jtag_queue_optimizer_stats.bits_saved +=
+					tap_get_tms_path_len(prev->cmd.scan->end_state, shift) + 1;
+				jtag_scan_merge(prev->cmd.scan, scan);
+				/* the IR contents are only known once the whole scan is merged */
+				if (scan->ir_scan)
+					last_ir = prev->cmd.scan;
+				state = scan->end_state;
+				drop = true;
+				break;
+			}
+
+			if (scan->ir_scan)
+				last_ir = scan;
+			state = scan->end_state;
+			break;
+		}
+		case JTAG_RUNTEST:
+			if (prev && prev->type == JTAG_RUNTEST &&
+					prev->cmd.runtest->end_state == TAP_IDLE) {
+				prev->cmd.runtest->num_cycles += cmd->cmd.runtest->num_cycles;
+				prev->cmd.runtest->end_state = cmd->cmd.runtest->end_state;
+				jtag_queue_optimizer_stats.runtests_merged++;
+				drop = true;
+			}
+			state = cmd->cmd.runtest->end_state;
+			break;
+		case JTAG_TLR_RESET:
+			state = cmd->cmd.statemove->end_state;
+			last_ir = NULL;
+			break;
+		case JTAG_PATHMOVE:
+			if (cmd->cmd.pathmove->num_states > 0)
+				state = cmd->cmd.pathmove->path[cmd->cmd.pathmove->num_states - 1];
+			last_ir = NULL;
+			break;
+		case JTAG_SLEEP:
+		case JTAG_STABLECLOCKS:
+			break;
+		default:
+			/* TRST/SRST and raw TMS sequences may change anything */
+			state = TAP_INVALID;
+			last_ir = NULL;
+			break;
+		}
+
+		if (drop) {
+			*p_cmd = cmd->next;
+			continue;
+		}
+
+		prev = cmd;
+		p_cmd = &cmd->next;
+	}
+
+	next_command_pointer = p_cmd;
+}
+
 /**
  * Copy a struct scan_field for insertion into the queue.
  *
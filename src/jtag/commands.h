@@ -164,10 +164,27 @@ struct jtag_command {
 extern struct jtag_command *jtag_command_queue;
 
 void *cmd_queue_alloc(size_t size);
+/** Release all memory held by the command queue allocator. */
+void cmd_queue_free(void);
 
 void jtag_queue_command(struct jtag_command *cmd);
 void jtag_command_queue_reset(void);
 
+/** Counters of the work saved by jtag_command_queue_optimize(). */
+struct jtag_queue_optimizer_stats {
+	/** IR scans dropped because the IR already held the value */
+	unsigned ir_scans_elided;
+	/** runtest commands folded into the preceding one */
+	unsigned runtests_merged;
+	/** scans appended to a preceding scan ending in a pause state */
+	unsigned scans_merged;
+	/** estimated TCK cycles no longer sent to the adapter */
+	uint64_t bits_saved;
+};
+
+void jtag_command_queue_optimize(void);
+const struct jtag_queue_optimizer_stats *jtag_command_queue_optimizer_stats(void);
+
 void jtag_scan_field_clone(struct scan_field *dst, const struct scan_field *src);
 enum scan_type jtag_scan_type(const struct scan_command *cmd);
 int jtag_scan_size(const struct scan_command *cmd);
@@ -33,8 +33,10 @@
 #include "jtag.h"
 #include "swd.h"
 #include "interface.h"
+#include "commands.h"
 #include <transport/transport.h>
 #include <helper/jep106.h>
+#include <helper/perf.h>
 
 #ifdef HAVE_STRINGS_H
 #include <strings.h>
@@ -94,6 +96,7 @@ static enum reset_types jtag_reset_config = RESET_NONE;
 tap_state_t cmd_queue_cur_state = TAP_RESET;
 
 static bool jtag_verify_capture_ir = true;
+static bool jtag_queue_optimize;
 static int jtag_verify = 1;
 
 /* how long the OpenOCD should wait before attempting JTAG communication after reset lines
@@ -836,7 +839,26 @@ int default_interface_jtag_execute_queue(void)
 		return ERROR_FAIL;
 	}
 
-	return jtag->execute_queue();
+	if (jtag_queue_optimize)
+		jtag_command_queue_optimize();
+
+	static struct perf_stat jtag_queue_stat = PERF_STAT_INIT("jtag.queue");
+	int64_t start = perf_start();
+	uint64_t commands = 0, scan_bits = 0;
+
+	if (start) {
+		for (struct jtag_command *cmd = jtag_command_queue; cmd; cmd = cmd->next) {
+			commands++;
+			if (cmd->type == JTAG_SCAN)
+				scan_bits += jtag_scan_size(cmd->cmd.scan);
+		}
+	}
+
+	int retval = jtag->execute_queue();
+
+	perf_end(&jtag_queue_stat, start, commands, DIV_ROUND_UP(scan_bits, 8), retval);
+
+	return retval;
 }
 
 void jtag_execute_queue_noclear(void)
@@ -1494,6 +1516,8 @@ int adapter_quit(void)
 		t = n;
 	}
 
+	cmd_queue_free();
+
 	return ERROR_OK;
 }
 
@@ -1704,6 +1728,16 @@ bool jtag_will_verify_capture_ir()
 	return jtag_verify_capture_ir;
 }
 
+void jtag_set_queue_optimize(bool enable)
+{
+	jtag_queue_optimize = enable;
+}
+
+bool jtag_will_optimize_queue(void)
+{
+	return jtag_queue_optimize;
+}
+
 int jtag_power_dropout(int *dropout)
 {
 	if (jtag == NULL) {
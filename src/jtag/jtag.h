@@ -295,6 +295,11 @@ void jtag_set_verify_capture_ir(bool enable);
 /** @returns True if IR scan verification will be performed. */
 bool jtag_will_verify_capture_ir(void);
 
+/** Enable or disable the optimization pass run before each queue flush. */
+void jtag_set_queue_optimize(bool enable);
+/** @returns True if queued commands are optimized before execution. */
+bool jtag_will_optimize_queue(void);
+
 /** Initialize debug adapter upon startup.  */
 int adapter_init(struct command_context *cmd_ctx);
 
@@ -36,6 +36,7 @@
 #include "interface.h"
 #include "interfaces.h"
 #include "tcl.h"
+#include "commands.h"
 
 #ifdef HAVE_STRINGS_H
 #include <strings.h>
@@ -1198,6 +1199,28 @@ COMMAND_HANDLER(handle_verify_jtag_command)
 	return ERROR_OK;
 }
 
+COMMAND_HANDLER(handle_jtag_queue_optimize_command)
+{
+	if (CMD_ARGC > 1)
+		return ERROR_COMMAND_SYNTAX_ERROR;
+
+	if (CMD_ARGC == 1) {
+		bool enable;
+		COMMAND_PARSE_ENABLE(CMD_ARGV[0], enable);
+		jtag_set_queue_optimize(enable);
+	}
+
+	const struct jtag_queue_optimizer_stats *stats = jtag_command_queue_optimizer_stats();
+	command_print(CMD_CTX, "jtag queue optimization is %s",
+		jtag_will_optimize_queue() ? "enabled" : "disabled");
+	command_print(CMD_CTX, "IR scans elided: %u, runtests merged: %u, "
+		"scans merged: %u, TCK cycles saved: %" PRIu64,
+		stats->ir_scans_elided, stats->runtests_merged,
+		stats->scans_merged, stats->bits_saved);
+
+	return ERROR_OK;
+}
+
 COMMAND_HANDLER(handle_tms_sequence_command)
 {
 	if (CMD_ARGC > 1)
@@ -1349,6 +1372,14 @@ static const struct command_registration jtag_command_handlers[] = {
 			"verify values captured during IR and DR scans.",
 		.usage = "['enable'|'disable']",
 	},
+	{
+		.name = "jtag_queue_optimize",
+		.handler = handle_jtag_queue_optimize_command,
+		.mode = COMMAND_ANY,
+		.help = "Display or assign flag controlling whether queued "
+			"scans are coalesced before being sent to the adapter.",
+		.usage = "['enable'|'disable']",
+	},
 	{
 		.name = "tms_sequence",
 		.handler = handle_tms_sequence_command,
@@ -27,12 +27,14 @@
 #endif
 
 #include "openocd.h"
+#include "perf_bench.h"
 #include <jtag/driver.h>
 #include <jtag/jtag.h>
 #include <transport/transport.h>
 #include <helper/ioutil.h>
 #include <helper/util.h>
 #include <helper/configuration.h>
+#include <helper/perf.h>
 #include <flash/nor/core.h>
 #include <flash/nand/core.h>
 #include <pld/pld.h>
@@ -42,6 +44,8 @@
 
 #include <server/server.h>
 #include <server/gdb_server.h>
+#include <server/rtt_server.h>
+#include <rtt/rtt.h>
 
 #ifdef HAVE_STRINGS_H
 #include <strings.h>
@@ -251,6 +255,8 @@ struct command_context *setup_command_handler(Jim_Interp *interp)
 		&server_register_commands,
 		&gdb_register_commands,
 		&log_register_commands,
+		&perf_register_commands,
+		&perf_bench_register_commands,
 		&transport_register_commands,
 		&interface_register_commands,
 		&target_register_commands,
@@ -260,6 +266,8 @@ struct command_context *setup_command_handler(Jim_Interp *interp)
 		&mflash_register_commands,
 		&cti_register_commands,
 		&dap_register_commands,
+		&rtt_register_commands,
+		&rtt_server_register_commands,
 		NULL
 	};
 	for (unsigned i = 0; NULL != command_registrants[i]; i++) {
@@ -356,6 +364,7 @@ int openocd_main(int argc, char *argv[])
 	flash_free_all_banks();
 	gdb_service_free();
 	server_free();
+	rtt_exit();
 
 	unregister_all_commands(cmd_ctx, NULL);
 
@@ -0,0 +1,420 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by the OpenOCD developers                          *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+/**
+ * @file
+ * Benchmarks of OpenOCD's own host side hot paths ("perf bench host"),
+ * of target memory access through the configured adapter ("perf bench
+ * target") and of image loading ("perf bench image"). Results are printed
+ * as a table, or as JSON for tracking them across builds.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "perf_bench.h"
+#include <helper/binarybuffer.h>
+#include <helper/command.h>
+#include <helper/log.h>
+#include <helper/time_support.h>
+#include <jtag/jtag.h>
+#include <jtag/commands.h>
+#include <target/image.h>
+#include <target/target.h>
+
+/* each benchmark is repeated for at least this long */
+#define PERF_BENCH_MIN_US	200000
+
+#define PERF_BENCH_BUF_SIZE	(64 * 1024)
+
+struct perf_bench_data {
+	uint8_t src[PERF_BENCH_BUF_SIZE + 8];
+	uint8_t dst[PERF_BENCH_BUF_SIZE + 8];
+	uint8_t mask[PERF_BENCH_BUF_SIZE];
+	char hex[2 * PERF_BENCH_BUF_SIZE + 1];
+};
+
+struct perf_bench {
+	const char *name;
+	/* run the benchmark once, adding the operations and bytes it did */
+	bool (*run)(struct perf_bench_data *data, uint64_t *ops, uint64_t *bytes);
+};
+
+struct perf_bench_result {
+	const char *name;
+	uint64_t ops;
+	uint64_t bytes;
+	int64_t elapsed_us;
+};
+
+static bool perf_bench_copy_aligned(struct perf_bench_data *data, uint64_t *ops, uint64_t *bytes)
+{
+	buf_set_buf(data->src, 0, data->dst, 0, PERF_BENCH_BUF_SIZE * 8);
+	*ops += 1;
+	*bytes += PERF_BENCH_BUF_SIZE;
+	return true;
+}
+
+static bool perf_bench_copy_unaligned(struct perf_bench_data *data, uint64_t *ops, uint64_t *bytes)
+{
+	buf_set_buf(data->src, 3, data->dst, 5, PERF_BENCH_BUF_SIZE * 8);
+	*ops += 1;
+	*bytes += PERF_BENCH_BUF_SIZE;
+	return true;
+}
+
+static bool perf_bench_cmp_mask(struct perf_bench_data *data, uint64_t *ops, uint64_t *bytes)
+{
+	/* identical buffers, so the whole range is compared */
+	if (buf_cmp_mask(data->src, data->src, data->mask, PERF_BENCH_BUF_SIZE * 8))
+		return false;
+	*ops += 1;
+	*bytes += PERF_BENCH_BUF_SIZE;
+	return true;
+}
+
+static bool perf_bench_crc(struct perf_bench_data *data, uint64_t *ops, uint64_t *bytes)
+{
+	uint32_t checksum;
+
+	if (image_calculate_checksum(data->src, PERF_BENCH_BUF_SIZE, &checksum) != ERROR_OK)
+		return false;
+	*ops += 1;
+	*bytes += PERF_BENCH_BUF_SIZE;
+	return true;
+}
+
+static bool perf_bench_hexify(struct perf_bench_data *data, uint64_t *ops, uint64_t *bytes)
+{
+	hexify(data->hex, data->src, PERF_BENCH_BUF_SIZE, sizeof(data->hex));
+	*ops += 1;
+	*bytes += PERF_BENCH_BUF_SIZE;
+	return true;
+}
+
+static bool perf_bench_unhexify(struct perf_bench_data *data, uint64_t *ops, uint64_t *bytes)
+{
+	if (unhexify(data->dst, data->hex, PERF_BENCH_BUF_SIZE) != PERF_BENCH_BUF_SIZE)
+		return false;
+	*ops += 1;
+	*bytes += PERF_BENCH_BUF_SIZE;
+	return true;
+}
+
+static bool perf_bench_cmd_queue_alloc(struct perf_bench_data *data, uint64_t *ops, uint64_t *bytes)
+{
+	/* don't throw away commands somebody queued */
+	if (jtag_command_queue != NULL)
+		return false;
+
+	for (unsigned int i = 0; i < 1024; i++) {
+		if (cmd_queue_alloc(64) == NULL)
+			return false;
+	}
+	jtag_command_queue_reset();
+
+	*ops += 1024;
+	*bytes += 1024 * 64;
+	return true;
+}
+
+static const struct perf_bench perf_bench_host[] = {
+	{ "buf_set_buf.aligned", perf_bench_copy_aligned },
+	{ "buf_set_buf.unaligned", perf_bench_copy_unaligned },
+	{ "buf_cmp_mask", perf_bench_cmp_mask },
+	{ "crc32", perf_bench_crc },
+	{ "hexify", perf_bench_hexify },
+	{ "unhexify", perf_bench_unhexify },
+	{ "cmd_queue_alloc", perf_bench_cmd_queue_alloc },
+};
+
+static void perf_bench_print(struct command_context *cmd_ctx,
+	const struct perf_bench_result *results, unsigned int count, bool json)
+{
+	if (json) {
+		command_print_sameline(cmd_ctx, "{\"benchmarks\":[");
+		for (unsigned int i = 0; i < count; i++) {
+			const struct perf_bench_result *r = &results[i];
+			command_print_sameline(cmd_ctx,
+				"%s{\"name\":\"%s\",\"ops\":%" PRIu64 ",\"bytes\":%" PRIu64
+				",\"elapsed_us\":%" PRId64 "}",
+				i ? "," : "", r->name, r->ops, r->bytes, r->elapsed_us);
+		}
+		command_print(cmd_ctx, "]}");
+		return;
+	}
+
+	command_print(cmd_ctx, "%-24s %12s %10s %12s", "name", "ops", "ns/op", "MiB/s");
+	for (unsigned int i = 0; i < count; i++) {
+		const struct perf_bench_result *r = &results[i];
+		double seconds = r->elapsed_us / 1e6;
+
+		command_print(cmd_ctx, "%-24s %12" PRIu64 " %10.1f %12.2f", r->name, r->ops,
+			r->ops ? r->elapsed_us * 1e3 / r->ops : 0.0,
+			seconds > 0 ? r->bytes / seconds / (1024 * 1024) : 0.0);
+	}
+}
+
+/* strip an optional trailing 'json' from the arguments */
+static bool perf_bench_json_arg(const char **argv, unsigned int *argc)
+{
+	if (*argc > 0 && strcmp(argv[*argc - 1], "json") == 0) {
+		(*argc)--;
+		return true;
+	}
+
+	return false;
+}
+
+COMMAND_HANDLER(handle_perf_bench_host_command)
+{
+	unsigned int argc = CMD_ARGC;
+	bool json = perf_bench_json_arg(CMD_ARGV, &argc);
+	struct perf_bench_result results[ARRAY_SIZE(perf_bench_host)];
+	unsigned int count = 0;
+
+	if (argc != 0)
+		return ERROR_COMMAND_SYNTAX_ERROR;
+
+	struct perf_bench_data *data = malloc(sizeof(*data));
+	if (data == NULL) {
+		LOG_ERROR("Out of memory");
+		return ERROR_FAIL;
+	}
+
+	for (unsigned int i = 0; i < sizeof(data->src); i++)
+		data->src[i] = i * 0x9e3779b1 >> 24;
+	memset(data->mask, 0xff, sizeof(data->mask));
+	hexify(data->hex, data->src, PERF_BENCH_BUF_SIZE, sizeof(data->hex));
+
+	for (unsigned int i = 0; i < ARRAY_SIZE(perf_bench_host); i++) {
+		const struct perf_bench *bench = &perf_bench_host[i];
+		struct perf_bench_result *r = &results[count];
+		int64_t start = monotonic_us();
+		bool ok;
+
+		r->name = bench->name;
+		r->ops = 0;
+		r->bytes = 0;
+		do {
+			ok = bench->run(data, &r->ops, &r->bytes);
+			r->elapsed_us = monotonic_us() - start;
+		} while (ok && r->elapsed_us < PERF_BENCH_MIN_US);
+		keep_alive();
+
+		if (ok)
+			count++;
+		else
+			LOG_WARNING("benchmark %s skipped", bench->name);
+	}
+
+	free(data);
+
+	perf_bench_print(CMD_CTX, results, count, json);
+
+	return ERROR_OK;
+}
+
+COMMAND_HANDLER(handle_perf_bench_target_command)
+{
+	unsigned int argc = CMD_ARGC;
+	bool json = perf_bench_json_arg(CMD_ARGV, &argc);
+	struct perf_bench_result results[2];
+	target_addr_t address;
+	uint32_t size;
+	int retval;
+
+	if (argc != 2)
+		return ERROR_COMMAND_SYNTAX_ERROR;
+
+	COMMAND_PARSE_ADDRESS(CMD_ARGV[0], address);
+	COMMAND_PARSE_NUMBER(u32, CMD_ARGV[1], size);
+	if (size == 0)
+		return ERROR_COMMAND_SYNTAX_ERROR;
+
+	struct target *target = get_current_target(CMD_CTX);
+
+	uint8_t *saved = malloc(size);
+	uint8_t *pattern = malloc(size);
+	uint8_t *readback = malloc(size);
+	if (saved == NULL || pattern == NULL || readback == NULL) {
+		LOG_ERROR("Out of memory");
+		retval = ERROR_FAIL;
+		goto done;
+	}
+
+	for (uint32_t i = 0; i < size; i++)
+		pattern[i] = i * 0x9e3779b1 >> 24;
+
+	/* the memory is given back as it was found */
+	retval = target_read_buffer(target, address, size, saved);
+	if (retval != ERROR_OK)
+		goto done;
+
+	results[0].name = "target.write";
+	results[1].name = "target.read";
+	for (unsigned int i = 0; i < 2; i++) {
+		int64_t start = monotonic_us();
+
+		results[i].ops = 0;
+		results[i].bytes = 0;
+		do {
+			if (i == 0)
+				retval = target_write_buffer(target, address, size, pattern);
+			else
+				retval = target_read_buffer(target, address, size, readback);
+			if (retval != ERROR_OK)
+				break;
+			results[i].ops++;
+			results[i].bytes += size;
+			results[i].elapsed_us = monotonic_us() - start;
+		} while (results[i].elapsed_us < PERF_BENCH_MIN_US);
+		keep_alive();
+
+		if (retval != ERROR_OK)
+			break;
+	}
+
+	int restore = target_write_buffer(target, address, size, saved);
+	if (retval == ERROR_OK)
+		retval = restore;
+	if (retval != ERROR_OK)
+		goto done;
+
+	if (memcmp(pattern, readback, size) != 0) {
+		LOG_ERROR("memory at " TARGET_ADDR_FMT " did not read back as written", address);
+		retval = ERROR_FAIL;
+		goto done;
+	}
+
+	perf_bench_print(CMD_CTX, results, 2, json);
+
+done:
+	free(readback);
+	free(pattern);
+	free(saved);
+
+	return retval;
+}
+
+COMMAND_HANDLER(handle_perf_bench_image_command)
+{
+	unsigned int argc = CMD_ARGC;
+	bool json = perf_bench_json_arg(CMD_ARGV, &argc);
+	struct perf_bench_result result = { .name = "image.load" };
+	struct image image;
+	int retval = ERROR_OK;
+
+	if (argc < 1 || argc > 2)
+		return ERROR_COMMAND_SYNTAX_ERROR;
+
+	image.base_address_set = 0;
+	image.start_address_set = 0;
+
+	int64_t start = monotonic_us();
+	do {
+		retval = image_open(&image, CMD_ARGV[0], (argc == 2) ? CMD_ARGV[1] : NULL);
+		if (retval != ERROR_OK)
+			return retval;
+
+		for (int i = 0; i < image.num_sections; i++) {
+			uint8_t *data;
+			size_t size_read;
+
+			/* plain buffer reads are what the flash and load paths fall back to */
+			data = malloc(image.sections[i].size);
+			if (data == NULL) {
+				retval = ERROR_FAIL;
+				break;
+			}
+			retval = image_read_section(&image, i, 0, image.sections[i].size,
+					data, &size_read);
+			free(data);
+			if (retval != ERROR_OK)
+				break;
+			result.bytes += size_read;
+		}
+
+		image_close(&image);
+		if (retval != ERROR_OK)
+			return retval;
+
+		result.ops++;
+		result.elapsed_us = monotonic_us() - start;
+		keep_alive();
+	} while (result.elapsed_us < PERF_BENCH_MIN_US);
+
+	perf_bench_print(CMD_CTX, &result, 1, json);
+
+	return ERROR_OK;
+}
+
+static const struct command_registration perf_bench_subcommand_handlers[] = {
+	{
+		.name = "host",
+		.handler = handle_perf_bench_host_command,
+		.mode = COMMAND_ANY,
+		.help = "benchmark host side helpers: bit buffers, CRC, hex "
+			"conversion and JTAG command allocation",
+		.usage = "['json']",
+	},
+	{
+		.name = "target",
+		.handler = handle_perf_bench_target_command,
+		.mode = COMMAND_EXEC,
+		.help = "benchmark writing and reading target memory, which is "
+			"restored afterwards",
+		.usage = "address size ['json']",
+	},
+	{
+		.name = "image",
+		.handler = handle_perf_bench_image_command,
+		.mode = COMMAND_ANY,
+		.help = "benchmark opening and reading an image file",
+		.usage = "filename [type] ['json']",
+	},
+	COMMAND_REGISTRATION_DONE
+};
+
+static const struct command_registration perf_bench_command_handlers[] = {
+	{
+		.name = "bench",
+		.mode = COMMAND_ANY,
+		.help = "benchmarks of OpenOCD's hot paths",
+		.usage = "",
+		.chain = perf_bench_subcommand_handlers,
+	},
+	COMMAND_REGISTRATION_DONE
+};
+
+static const struct command_registration perf_command_handlers[] = {
+	{
+		.name = "perf",
+		.mode = COMMAND_ANY,
+		.help = "performance statistics of the JTAG, DAP, target, flash "
+			"and GDB layers",
+		.usage = "",
+		.chain = perf_bench_command_handlers,
+	},
+	COMMAND_REGISTRATION_DONE
+};
+
+int perf_bench_register_commands(struct command_context *cmd_ctx)
+{
+	return register_commands(cmd_ctx, NULL, perf_command_handlers);
+}
@@ -105,6 +105,7 @@ static int FreeRTOS_update_threads(struct rtos *rtos);
 static int FreeRTOS_get_thread_reg_list(struct rtos *rtos, int64_t thread_id,
 		struct rtos_reg **reg_list, int *num_regs);
 static int FreeRTOS_get_symbol_list_to_lookup(symbol_table_elem_t *symbol_list[]);
+static void FreeRTOS_destroy(struct target *target);
 
 struct rtos_type FreeRTOS_rtos = {
 	.name = "FreeRTOS",
@@ -114,6 +115,7 @@ struct rtos_type FreeRTOS_rtos = {
 	.update_threads = FreeRTOS_update_threads,
 	.get_thread_reg_list = FreeRTOS_get_thread_reg_list,
 	.get_symbol_list_to_lookup = FreeRTOS_get_symbol_list_to_lookup,
+	.destroy = FreeRTOS_destroy,
 };
 
 enum FreeRTOS_symbol_values {
@@ -128,6 +130,7 @@ enum FreeRTOS_symbol_values {
 	FreeRTOS_VAL_xSuspendedTaskList = 8,
 	FreeRTOS_VAL_uxCurrentNumberOfTasks = 9,
 	FreeRTOS_VAL_uxTopUsedPriority = 10,
+	FreeRTOS_VAL_uxTaskNumber = 11,
 };
 
 struct symbols {
@@ -147,25 +150,155 @@ static const struct symbols FreeRTOS_symbol_list[] = {
 	{ "xSuspendedTaskList", true }, /* Only if INCLUDE_vTaskSuspend */
 	{ "uxCurrentNumberOfTasks", false },
 	{ "uxTopUsedPriority", true }, /* Unavailable since v7.5.3 */
+	{ "uxTaskNumber", true }, /* Only used to detect new tasks */
 	{ NULL, false }
 };
 
-/* TODO: */
-/* this is not safe for little endian yet */
-/* may be problems reading if sizes are not 32 bit long integers. */
-/* test mallocs for failure */
+/* list heads closer together than this are fetched with a single read */
+#define FREERTOS_READ_GAP	64
+
+#define FREERTOS_THREAD_NAME_STR_SIZE (200)
+
+struct FreeRTOS {
+	const struct FreeRTOS_params *param;
+	struct target *target;
+	/* uxTaskNumber and uxCurrentNumberOfTasks seen by the last update;
+	 * while neither changes the set of tasks is the same */
+	bool valid;
+	uint64_t task_number;
+	uint64_t thread_count;
+};
+
+static uint64_t FreeRTOS_get_value(struct target *target, const uint8_t *buf,
+		unsigned int width)
+{
+	switch (width) {
+	case 8:
+		return target_buffer_get_u64(target, buf);
+	case 4:
+		return target_buffer_get_u32(target, buf);
+	case 2:
+		return target_buffer_get_u16(target, buf);
+	default:
+		return buf[0];
+	}
+}
+
+static int FreeRTOS_read_value(struct target *target, symbol_address_t address,
+		unsigned int width, uint64_t *value)
+{
+	uint8_t buf[8];
+
+	int retval = target_read_buffer(target, address, width, buf);
+	if (retval != ERROR_OK)
+		return retval;
+
+	*value = FreeRTOS_get_value(target, buf, width);
+	return ERROR_OK;
+}
+
+/*
+ * Read the headers of @a num_lists lists into @a heads, merging lists that
+ * sit next to each other in memory (the ready lists always do, the
+ * others usually) into one read.
+ */
+static int FreeRTOS_read_lists(struct rtos *rtos, const symbol_address_t *lists,
+		int num_lists, uint8_t *heads)
+{
+	const struct FreeRTOS *freertos = rtos->rtos_specific_params;
+	unsigned int width = freertos->param->list_width;
+	int i = 0;
+
+	while (i < num_lists) {
+		if (lists[i] == 0) {
+			i++;
+			continue;
+		}
+
+		symbol_address_t start = lists[i];
+		symbol_address_t end = start + width;
+		int last = i;
+		while (last + 1 < num_lists && lists[last + 1] >= end &&
+				lists[last + 1] <= end + FREERTOS_READ_GAP) {
+			last++;
+			end = lists[last] + width;
+		}
+
+		uint8_t *span = malloc(end - start);
+		if (!span)
+			return ERROR_FAIL;
+
+		int retval = target_read_buffer(rtos->target, start, end - start, span);
+		if (retval != ERROR_OK) {
+			free(span);
+			return retval;
+		}
+
+		for (; i <= last; i++)
+			memcpy(heads + i * width, span + (lists[i] - start), width);
+
+		free(span);
+	}
+
+	return ERROR_OK;
+}
+
+static void FreeRTOS_set_running(struct rtos *rtos)
+{
+	static const char running_str[] = "State: Running";
+
+	for (int i = 0; i < rtos->thread_count; i++) {
+		struct thread_detail *detail = &rtos->thread_details[i];
+
+		free(detail->extra_info_str);
+		detail->extra_info_str = NULL;
+
+		if (detail->threadid == rtos->current_thread)
+			detail->extra_info_str = strdup(running_str);
+	}
+}
+
+/* Take the name of @a threadid over from the previous thread list */
+static char *FreeRTOS_take_name(struct thread_detail *old, int old_count,
+		threadid_t threadid)
+{
+	for (int i = 0; i < old_count; i++) {
+		if (old[i].threadid == threadid && old[i].thread_name_str) {
+			char *name = old[i].thread_name_str;
+			old[i].thread_name_str = NULL;
+			return name;
+		}
+	}
+
+	return NULL;
+}
+
+static void FreeRTOS_free_details(struct thread_detail *details, int count)
+{
+	if (!details)
+		return;
+
+	for (int i = 0; i < count; i++) {
+		free(details[i].thread_name_str);
+		free(details[i].extra_info_str);
+	}
+	free(details);
+}
 
 static int FreeRTOS_update_threads(struct rtos *rtos)
 {
 	int i = 0;
 	int retval;
 	int tasks_found = 0;
+	struct FreeRTOS *freertos;
 	const struct FreeRTOS_params *param;
+	struct target *target = rtos->target;
 
 	if (rtos->rtos_specific_params == NULL)
 		return -1;
 
-	param = (const struct FreeRTOS_params *) rtos->rtos_specific_params;
+	freertos = rtos->rtos_specific_params;
+	param = freertos->param;
 
 	if (rtos->symbols == NULL) {
 		LOG_ERROR("No symbols for FreeRTOS");
@@ -177,12 +310,11 @@ static int FreeRTOS_update_threads(struct rtos *rtos)
 		return -2;
 	}
 
-	int thread_list_size = 0;
-	retval = target_read_buffer(rtos->target,
+	uint64_t thread_list_size = 0;
+	retval = FreeRTOS_read_value(target,
 			rtos->symbols[FreeRTOS_VAL_uxCurrentNumberOfTasks].address,
-			param->thread_count_width,
-			(uint8_t *)&thread_list_size);
-	LOG_DEBUG("FreeRTOS: Read uxCurrentNumberOfTasks at 0x%" PRIx64 ", value %d\r\n",
+			param->thread_count_width, &thread_list_size);
+	LOG_DEBUG("FreeRTOS: Read uxCurrentNumberOfTasks at 0x%" PRIx64 ", value %" PRIu64 "\r\n",
 										rtos->symbols[FreeRTOS_VAL_uxCurrentNumberOfTasks].address,
 										thread_list_size);
 
@@ -191,21 +323,68 @@ static int FreeRTOS_update_threads(struct rtos *rtos)
 		return retval;
 	}
 
-	/* wipe out previous thread details if any */
-	rtos_free_threadlist(rtos);
+	/* uxTaskNumber counts the tasks ever created, it changes whenever
+	 * a task was created since the last update */
+	bool have_task_number = rtos->symbols[FreeRTOS_VAL_uxTaskNumber].address != 0;
+	uint64_t task_number = 0;
+	if (have_task_number) {
+		retval = FreeRTOS_read_value(target,
+				rtos->symbols[FreeRTOS_VAL_uxTaskNumber].address,
+				param->thread_count_width, &task_number);
+		if (retval != ERROR_OK) {
+			LOG_ERROR("Could not read FreeRTOS task number from target");
+			return retval;
+		}
+	}
 
 	/* read the current thread */
-	retval = target_read_buffer(rtos->target,
+	uint64_t current_thread = 0;
+	retval = FreeRTOS_read_value(target,
 			rtos->symbols[FreeRTOS_VAL_pxCurrentTCB].address,
-			param->pointer_width,
-			(uint8_t *)&rtos->current_thread);
+			param->pointer_width, &current_thread);
 	if (retval != ERROR_OK) {
 		LOG_ERROR("Error reading current thread in FreeRTOS thread list");
 		return retval;
 	}
 	LOG_DEBUG("FreeRTOS: Read pxCurrentTCB at 0x%" PRIx64 ", value 0x%" PRIx64 "\r\n",
 										rtos->symbols[FreeRTOS_VAL_pxCurrentTCB].address,
-										rtos->current_thread);
+										current_thread);
+
+	/* No task was created and none deleted: the tasks only moved between
+	 * lists, which we do not report, so keep the thread list and just
+	 * update which one is running. */
+	bool same_tasks = have_task_number && freertos->valid &&
+		task_number == freertos->task_number;
+	if (same_tasks && thread_list_size == freertos->thread_count &&
+			thread_list_size != 0 && current_thread != 0 &&
+			rtos->thread_details != NULL) {
+		rtos->current_thread = current_thread;
+		rtos->current_threadid = -1;
+		FreeRTOS_set_running(rtos);
+		LOG_DEBUG("FreeRTOS: thread list unchanged");
+		return ERROR_OK;
+	}
+
+	/* Keep the previous thread details around: as long as no task was
+	 * created, the names of the remaining tasks are still valid. */
+	struct thread_detail *old_details = rtos->thread_details;
+	int old_count = rtos->thread_count;
+	if (!same_tasks) {
+		FreeRTOS_free_details(old_details, old_count);
+		old_details = NULL;
+		old_count = 0;
+	}
+	rtos->thread_details = NULL;
+	rtos->thread_count = 0;
+	rtos->current_threadid = -1;
+	rtos->current_thread = current_thread;
+	freertos->valid = false;
+
+	if (thread_list_size > INT_MAX - 1) {
+		LOG_ERROR("FreeRTOS thread count is unreasonably big: %" PRIu64, thread_list_size);
+		FreeRTOS_free_details(old_details, old_count);
+		return ERROR_FAIL;
+	}
 
 	if ((thread_list_size  == 0) || (rtos->current_thread == 0)) {
 		/* Either : No RTOS threads - there is always at least the current execution though */
@@ -217,7 +396,8 @@ static int FreeRTOS_update_threads(struct rtos *rtos)
 		rtos->thread_details = malloc(
 				sizeof(struct thread_detail) * thread_list_size);
 		if (!rtos->thread_details) {
-			LOG_ERROR("Error allocating memory for %d threads", thread_list_size);
+			LOG_ERROR("Error allocating memory for %d threads", (int)thread_list_size);
+			FreeRTOS_free_details(old_details, old_count);
 			return ERROR_FAIL;
 		}
 		rtos->thread_details->threadid = 1;
@@ -228,6 +408,7 @@ static int FreeRTOS_update_threads(struct rtos *rtos)
 
 		if (thread_list_size == 1) {
 			rtos->thread_count = 1;
+			FreeRTOS_free_details(old_details, old_count);
 			return ERROR_OK;
 		}
 	} else {
@@ -235,7 +416,8 @@ static int FreeRTOS_update_threads(struct rtos *rtos)
 		rtos->thread_details = malloc(
 				sizeof(struct thread_detail) * thread_list_size);
 		if (!rtos->thread_details) {
-			LOG_ERROR("Error allocating memory for %d threads", thread_list_size);
+			LOG_ERROR("Error allocating memory for %d threads", (int)thread_list_size);
+			FreeRTOS_free_details(old_details, old_count);
 			return ERROR_FAIL;
 		}
 	}
@@ -243,34 +425,28 @@ static int FreeRTOS_update_threads(struct rtos *rtos)
 	/* Find out how many lists are needed to be read from pxReadyTasksLists, */
 	if (rtos->symbols[FreeRTOS_VAL_uxTopUsedPriority].address == 0) {
 		LOG_ERROR("FreeRTOS: uxTopUsedPriority is not defined, consult the OpenOCD manual for a work-around");
-		return ERROR_FAIL;
+		retval = ERROR_FAIL;
+		goto out;
 	}
-	int64_t max_used_priority = 0;
-	retval = target_read_buffer(rtos->target,
+	uint64_t max_used_priority = 0;
+	retval = FreeRTOS_read_value(target,
 			rtos->symbols[FreeRTOS_VAL_uxTopUsedPriority].address,
-			param->pointer_width,
-			(uint8_t *)&max_used_priority);
+			param->pointer_width, &max_used_priority);
 	if (retval != ERROR_OK)
-		return retval;
-	LOG_DEBUG("FreeRTOS: Read uxTopUsedPriority at 0x%" PRIx64 ", value %" PRId64 "\r\n",
+		goto out;
+	LOG_DEBUG("FreeRTOS: Read uxTopUsedPriority at 0x%" PRIx64 ", value %" PRIu64 "\r\n",
 										rtos->symbols[FreeRTOS_VAL_uxTopUsedPriority].address,
 										max_used_priority);
 	if (max_used_priority > FREERTOS_MAX_PRIORITIES) {
-		LOG_ERROR("FreeRTOS maximum used priority is unreasonably big, not proceeding: %" PRId64 "",
+		LOG_ERROR("FreeRTOS maximum used priority is unreasonably big, not proceeding: %" PRIu64 "",
 			max_used_priority);
-		return ERROR_FAIL;
-	}
-
-	symbol_address_t *list_of_lists =
-		malloc(sizeof(symbol_address_t) *
-			(max_used_priority+1 + 5));
-	if (!list_of_lists) {
-		LOG_ERROR("Error allocating memory for %" PRId64 " priorities", max_used_priority);
-		return ERROR_FAIL;
+		retval = ERROR_FAIL;
+		goto out;
 	}
 
+	symbol_address_t list_of_lists[FREERTOS_MAX_PRIORITIES + 1 + 5];
 	int num_lists;
-	for (num_lists = 0; num_lists <= max_used_priority; num_lists++)
+	for (num_lists = 0; num_lists <= (int)max_used_priority; num_lists++)
 		list_of_lists[num_lists] = rtos->symbols[FreeRTOS_VAL_pxReadyTasksLists].address +
 			num_lists * param->list_width;
 
@@ -280,120 +456,124 @@ static int FreeRTOS_update_threads(struct rtos *rtos)
 	list_of_lists[num_lists++] = rtos->symbols[FreeRTOS_VAL_xSuspendedTaskList].address;
 	list_of_lists[num_lists++] = rtos->symbols[FreeRTOS_VAL_xTasksWaitingTermination].address;
 
+	uint8_t *heads = malloc(num_lists * param->list_width);
+	if (!heads) {
+		LOG_ERROR("Error allocating memory for %d FreeRTOS lists", num_lists);
+		retval = ERROR_FAIL;
+		goto out;
+	}
+
+	retval = FreeRTOS_read_lists(rtos, list_of_lists, num_lists, heads);
+	if (retval != ERROR_OK) {
+		LOG_ERROR("Error reading FreeRTOS thread lists");
+		free(heads);
+		goto out;
+	}
+
+	/* next pointer and owner of a list item are fetched together */
+	unsigned int elem_lo = MIN(param->list_elem_next_offset, param->list_elem_content_offset);
+	unsigned int elem_hi = MAX(param->list_elem_next_offset, param->list_elem_content_offset) +
+		param->pointer_width;
+	uint8_t elem[32];
+	assert(elem_hi - elem_lo <= sizeof(elem));
+
 	for (i = 0; i < num_lists; i++) {
 		if (list_of_lists[i] == 0)
 			continue;
 
-		/* Read the number of threads in this list */
-		int64_t list_thread_count = 0;
-		retval = target_read_buffer(rtos->target,
-				list_of_lists[i],
-				param->thread_count_width,
-				(uint8_t *)&list_thread_count);
-		if (retval != ERROR_OK) {
-			LOG_ERROR("Error reading number of threads in FreeRTOS thread list");
-			free(list_of_lists);
-			return retval;
-		}
-		LOG_DEBUG("FreeRTOS: Read thread count for list %d at 0x%" PRIx64 ", value %" PRId64 "\r\n",
+		const uint8_t *head = heads + i * param->list_width;
+
+		/* The number of threads in this list */
+		uint64_t list_thread_count = FreeRTOS_get_value(target, head,
+				param->thread_count_width);
+		LOG_DEBUG("FreeRTOS: Read thread count for list %d at 0x%" PRIx64 ", value %" PRIu64 "\r\n",
 										i, list_of_lists[i], list_thread_count);
 
 		if (list_thread_count == 0)
 			continue;
 
-		/* Read the location of first list item */
+		/* The location of first list item */
 		uint64_t prev_list_elem_ptr = -1;
-		uint64_t list_elem_ptr = 0;
-		retval = target_read_buffer(rtos->target,
-				list_of_lists[i] + param->list_next_offset,
-				param->pointer_width,
-				(uint8_t *)&list_elem_ptr);
-		if (retval != ERROR_OK) {
-			LOG_ERROR("Error reading first thread item location in FreeRTOS thread list");
-			free(list_of_lists);
-			return retval;
-		}
+		uint64_t list_elem_ptr = FreeRTOS_get_value(target,
+				head + param->list_next_offset, param->pointer_width);
 		LOG_DEBUG("FreeRTOS: Read first item for list %d at 0x%" PRIx64 ", value 0x%" PRIx64 "\r\n",
 										i, list_of_lists[i] + param->list_next_offset, list_elem_ptr);
 
 		while ((list_thread_count > 0) && (list_elem_ptr != 0) &&
 				(list_elem_ptr != prev_list_elem_ptr) &&
-				(tasks_found < thread_list_size)) {
-			/* Get the location of the thread structure. */
-			rtos->thread_details[tasks_found].threadid = 0;
-			retval = target_read_buffer(rtos->target,
-					list_elem_ptr + param->list_elem_content_offset,
-					param->pointer_width,
-					(uint8_t *)&(rtos->thread_details[tasks_found].threadid));
+				(tasks_found < (int)thread_list_size)) {
+			struct thread_detail *detail = &rtos->thread_details[tasks_found];
+
+			/* Get the location of the thread structure and the next item */
+			retval = target_read_buffer(target, list_elem_ptr + elem_lo,
+					elem_hi - elem_lo, elem);
 			if (retval != ERROR_OK) {
-				LOG_ERROR("Error reading thread list item object in FreeRTOS thread list");
-				free(list_of_lists);
-				return retval;
+				LOG_ERROR("Error reading thread list item in FreeRTOS thread list");
+				free(heads);
+				goto out;
 			}
+			detail->threadid = FreeRTOS_get_value(target,
+					elem + param->list_elem_content_offset - elem_lo,
+					param->pointer_width);
 			LOG_DEBUG("FreeRTOS: Read Thread ID at 0x%" PRIx64 ", value 0x%" PRIx64 "\r\n",
 										list_elem_ptr + param->list_elem_content_offset,
-										rtos->thread_details[tasks_found].threadid);
+										detail->threadid);
 
 			/* get thread name */
-
-			#define FREERTOS_THREAD_NAME_STR_SIZE (200)
-			char tmp_str[FREERTOS_THREAD_NAME_STR_SIZE];
-
-			/* Read the thread name */
-			retval = target_read_buffer(rtos->target,
-					rtos->thread_details[tasks_found].threadid + param->thread_name_offset,
-					FREERTOS_THREAD_NAME_STR_SIZE,
-					(uint8_t *)&tmp_str);
-			if (retval != ERROR_OK) {
-				LOG_ERROR("Error reading first thread item location in FreeRTOS thread list");
-				free(list_of_lists);
-				return retval;
+			detail->thread_name_str = FreeRTOS_take_name(old_details, old_count,
+					detail->threadid);
+			if (!detail->thread_name_str) {
+				char tmp_str[FREERTOS_THREAD_NAME_STR_SIZE];
+
+				/* Read the thread name */
+				retval = target_read_buffer(target,
+						detail->threadid + param->thread_name_offset,
+						FREERTOS_THREAD_NAME_STR_SIZE,
+						(uint8_t *)&tmp_str);
+				if (retval != ERROR_OK) {
+					LOG_ERROR("Error reading first thread item location in FreeRTOS thread list");
+					free(heads);
+					goto out;
+				}
+				tmp_str[FREERTOS_THREAD_NAME_STR_SIZE-1] = '\x00';
+				LOG_DEBUG("FreeRTOS: Read Thread Name at 0x%" PRIx64 ", value \"%s\"\r\n",
+											detail->threadid + param->thread_name_offset,
+											tmp_str);
+
+				if (tmp_str[0] == '\x00')
+					strcpy(tmp_str, "No Name");
+
+				detail->thread_name_str = strdup(tmp_str);
 			}
-			tmp_str[FREERTOS_THREAD_NAME_STR_SIZE-1] = '\x00';
-			LOG_DEBUG("FreeRTOS: Read Thread Name at 0x%" PRIx64 ", value \"%s\"\r\n",
-										rtos->thread_details[tasks_found].threadid + param->thread_name_offset,
-										tmp_str);
-
-			if (tmp_str[0] == '\x00')
-				strcpy(tmp_str, "No Name");
-
-			rtos->thread_details[tasks_found].thread_name_str =
-				malloc(strlen(tmp_str)+1);
-			strcpy(rtos->thread_details[tasks_found].thread_name_str, tmp_str);
-			rtos->thread_details[tasks_found].exists = true;
-
-			if (rtos->thread_details[tasks_found].threadid == rtos->current_thread) {
-				char running_str[] = "State: Running";
-				rtos->thread_details[tasks_found].extra_info_str = malloc(
-						sizeof(running_str));
-				strcpy(rtos->thread_details[tasks_found].extra_info_str,
-					running_str);
-			} else
-				rtos->thread_details[tasks_found].extra_info_str = NULL;
+			detail->exists = true;
+			detail->extra_info_str = NULL;
 
 			tasks_found++;
+			rtos->thread_count = tasks_found;
 			list_thread_count--;
 
 			prev_list_elem_ptr = list_elem_ptr;
-			list_elem_ptr = 0;
-			retval = target_read_buffer(rtos->target,
-					prev_list_elem_ptr + param->list_elem_next_offset,
-					param->pointer_width,
-					(uint8_t *)&list_elem_ptr);
-			if (retval != ERROR_OK) {
-				LOG_ERROR("Error reading next thread item location in FreeRTOS thread list");
-				free(list_of_lists);
-				return retval;
-			}
+			list_elem_ptr = FreeRTOS_get_value(target,
+					elem + param->list_elem_next_offset - elem_lo,
+					param->pointer_width);
 			LOG_DEBUG("FreeRTOS: Read next thread location at 0x%" PRIx64 ", value 0x%" PRIx64 "\r\n",
 										prev_list_elem_ptr + param->list_elem_next_offset,
 										list_elem_ptr);
 		}
 	}
 
-	free(list_of_lists);
+	free(heads);
+	FreeRTOS_set_running(rtos);
+
+	freertos->valid = have_task_number;
+	freertos->task_number = task_number;
+	freertos->thread_count = thread_list_size;
+	retval = ERROR_OK;
+
+out:
 	rtos->thread_count = tasks_found;
-	return 0;
+	FreeRTOS_free_details(old_details, old_count);
+	return retval;
 }
 
 static int FreeRTOS_get_thread_reg_list(struct rtos *rtos, int64_t thread_id,
@@ -412,7 +592,7 @@ static int FreeRTOS_get_thread_reg_list(struct rtos *rtos, int64_t thread_id,
 	if (rtos->rtos_specific_params == NULL)
 		return -1;
 
-	param = (const struct FreeRTOS_params *) rtos->rtos_specific_params;
+	param = ((const struct FreeRTOS *) rtos->rtos_specific_params)->param;
 
 	/* Read the stack pointer */
 	retval = target_read_buffer(rtos->target,
@@ -503,9 +683,8 @@ static int FreeRTOS_get_thread_ascii_info(struct rtos *rtos, threadid_t thread_i
 	if (rtos->rtos_specific_params == NULL)
 		return -3;
 
-	param = (const struct FreeRTOS_params *) rtos->rtos_specific_params;
+	param = ((const struct FreeRTOS *) rtos->rtos_specific_params)->param;
 
-#define FREERTOS_THREAD_NAME_STR_SIZE (200)
 	char tmp_str[FREERTOS_THREAD_NAME_STR_SIZE];
 
 	/* Read the thread name */
@@ -539,6 +718,18 @@ static bool FreeRTOS_detect_rtos(struct target *target)
 	return false;
 }
 
+static int FreeRTOS_reset_handler(struct target *target,
+		enum target_reset_mode reset_mode, void *priv)
+{
+	struct FreeRTOS *freertos = priv;
+
+	/* the task list starts over after a reset */
+	if (target == freertos->target)
+		freertos->valid = false;
+
+	return ERROR_OK;
+}
+
 static int FreeRTOS_create(struct target *target)
 {
 	int i = 0;
@@ -551,6 +742,27 @@ static int FreeRTOS_create(struct target *target)
 		return -1;
 	}
 
-	target->rtos->rtos_specific_params = (void *) &FreeRTOS_params_list[i];
+	struct FreeRTOS *freertos = calloc(1, sizeof(*freertos));
+	if (!freertos) {
+		LOG_ERROR("FreeRTOS: out of memory");
+		return -1;
+	}
+	freertos->param = &FreeRTOS_params_list[i];
+	freertos->target = target;
+
+	target->rtos->rtos_specific_params = freertos;
+	target_register_reset_callback(FreeRTOS_reset_handler, freertos);
 	return 0;
 }
+
+static void FreeRTOS_destroy(struct target *target)
+{
+	struct FreeRTOS *freertos = target->rtos->rtos_specific_params;
+
+	if (!freertos)
+		return;
+
+	target_unregister_reset_callback(FreeRTOS_reset_handler, freertos);
+	free(freertos);
+	target->rtos->rtos_specific_params = NULL;
+}
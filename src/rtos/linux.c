@@ -36,6 +36,18 @@
 #include "linux_header.h"
 #define PHYS
 #define MAX_THREADS 200
+/*  kernel pages whose translation is remembered */
+#define LINUX_PAGE_SIZE 4096
+#define LINUX_TLB_SIZE 64
+/*  part of a task_struct read in one go, holding all fields we use */
+#define TASK_SLICE_SIZE (MAX(MAX(MAX(PID, MEM), MAX(ONCPU, NEXT)) + 4, COMM + 16))
+
+struct linux_tlb_entry {
+	uint32_t page;
+	uint32_t phys;
+	bool valid;
+};
+
 /*  specific task  */
 struct linux_os {
 	const char *name;
@@ -51,6 +63,8 @@ struct linux_os {
 	/*  virt2phys parameter */
 	uint32_t phys_mask;
 	uint32_t phys_base;
+	/*  translation cache, dropped when the target runs */
+	struct linux_tlb_entry tlb[LINUX_TLB_SIZE];
 };
 
 struct current_thread {
@@ -105,6 +119,12 @@ static int linux_os_dummy_update(struct rtos *rtos)
 	return 0;
 }
 
+static void linux_invalidate_tlb(struct linux_os *linux_os)
+{
+	for (int i = 0; i < LINUX_TLB_SIZE; i++)
+		linux_os->tlb[i].valid = false;
+}
+
 static int linux_compute_virt2phys(struct target *target, target_addr_t address)
 {
 	struct linux_os *linux_os = (struct linux_os *)
@@ -121,27 +141,89 @@ static int linux_compute_virt2phys(struct target *target, target_addr_t address)
 	linux_os->init_task_addr = address;
 	address = address & linux_os->phys_mask;
 	linux_os->phys_base = pa - address;
+	linux_invalidate_tlb(linux_os);
+	return ERROR_OK;
+}
+
+static int linux_event_handler(struct target *target, enum target_event event,
+	void *priv)
+{
+	if (target->rtos == NULL || target->rtos->rtos_specific_params != priv)
+		return ERROR_OK;
+
+	switch (event) {
+	case TARGET_EVENT_HALTED:
+	case TARGET_EVENT_RESUMED:
+	case TARGET_EVENT_RESET_ASSERT:
+		linux_invalidate_tlb(priv);
+		break;
+	default:
+		break;
+	}
+
 	return ERROR_OK;
 }
 
+/*  translate a kernel address, walking the page tables once per page */
+static uint32_t linux_virt2phys(struct target *target, uint32_t address)
+{
+	struct linux_os *linux_os = (struct linux_os *)
+		target->rtos->rtos_specific_params;
+	uint32_t page = address & ~(LINUX_PAGE_SIZE - 1);
+	struct linux_tlb_entry *entry =
+		&linux_os->tlb[(page / LINUX_PAGE_SIZE) % LINUX_TLB_SIZE];
+
+	if (!entry->valid || entry->page != page) {
+		target_addr_t pa;
+
+		if (target->type->virt2phys == NULL ||
+			target->type->virt2phys(target, page, &pa) != ERROR_OK) {
+			/*  fall back to the linear mapping of the kernel */
+			pa = (page & linux_os->phys_mask) + linux_os->phys_base;
+		}
+
+		entry->page = page;
+		entry->phys = pa;
+		entry->valid = true;
+	}
+
+	return entry->phys + (address - page);
+}
+
 static int linux_read_memory(struct target *target,
 	uint32_t address, uint32_t size, uint32_t count,
 	uint8_t *buffer)
 {
-#ifdef PHYS
-	struct linux_os *linux_os = (struct linux_os *)
-		target->rtos->rtos_specific_params;
-	uint32_t pa = (address & linux_os->phys_mask) + linux_os->phys_base;
-#endif
 	if (address < 0xc000000) {
 		LOG_ERROR("linux awareness : address in user space");
 		return ERROR_FAIL;
 	}
 #ifdef PHYS
-	target_read_phys_memory(target, pa, size, count, buffer);
-#endif
-	target_read_memory(target, address, size, count, buffer);
+	/*  physical pages need not be contiguous, split at page boundaries */
+	while (count > 0) {
+		uint32_t in_page = LINUX_PAGE_SIZE - (address & (LINUX_PAGE_SIZE - 1));
+		uint32_t n = MIN(count, in_page / size);
+		int retval;
+
+		if (n == 0) {
+			/*  an unaligned item straddles two pages */
+			n = 1;
+			retval = target_read_memory(target, address, size, n, buffer);
+		} else {
+			retval = target_read_phys_memory(target,
+					linux_virt2phys(target, address), size, n, buffer);
+		}
+		if (retval != ERROR_OK)
+			return retval;
+
+		address += n * size;
+		buffer += n * size;
+		count -= n;
+	}
 	return ERROR_OK;
+#else
+	return target_read_memory(target, address, size, count, buffer);
+#endif
 }
 
 int fill_buffer(struct target *target, uint32_t addr, uint8_t *buffer)
@@ -240,6 +322,7 @@ static bool linux_os_detect(struct target *target)
 
 static int linux_os_smp_init(struct target *target);
 static int linux_os_clean(struct target *target);
+static void linux_os_destroy(struct target *target);
 #define INIT_TASK 0
 static const char * const linux_symbol_list[] = {
 	"init_task",
@@ -270,6 +353,7 @@ const struct rtos_type Linux_os = {
 	.get_symbol_list_to_lookup = linux_get_symbol_list_to_lookup,
 	.clean = linux_os_clean,
 	.ps_command = linux_ps_command,
+	.destroy = linux_os_destroy,
 };
 
 static int linux_thread_packet(struct connection *connection, char const *packet,
@@ -296,57 +380,45 @@ int fill_task_pid(struct target *target, struct threads *t)
 int fill_task(struct target *target, struct threads *t)
 {
 	int retval;
-	uint32_t pid_addr = t->base_addr + PID;
-	uint32_t mem_addr = t->base_addr + MEM;
-	uint32_t on_cpu = t->base_addr + ONCPU;
-	uint8_t *buffer = calloc(1, 4);
-	retval = fill_buffer(target, t->base_addr, buffer);
+	uint8_t *buffer = malloc(TASK_SLICE_SIZE);
 
-	if (retval == ERROR_OK) {
-		uint32_t val = get_buffer(target, buffer);
-		t->state = val;
-	} else
-		LOG_ERROR("fill_task: unable to read memory");
+	if (buffer == NULL)
+		return ERROR_FAIL;
 
-	retval = fill_buffer(target, pid_addr, buffer);
+	/*  all fields we need sit in the first part of the task_struct,
+	 *  fetch it at once rather than field by field */
+	retval = linux_read_memory(target, t->base_addr, 4,
+			TASK_SLICE_SIZE / 4, buffer);
 
-	if (retval == ERROR_OK) {
-		uint32_t val = get_buffer(target, buffer);
-		t->pid = val;
-	} else
+	if (retval != ERROR_OK) {
 		LOG_ERROR("fill task: unable to read memory");
+		free(buffer);
+		return retval;
+	}
 
-	retval = fill_buffer(target, on_cpu, buffer);
+	t->state = get_buffer(target, buffer);
+	t->pid = get_buffer(target, buffer + PID);
+	t->oncpu = get_buffer(target, buffer + ONCPU);
+	memcpy(t->name, buffer + COMM, 16);
+	t->name[16] = 0;
 
-	if (retval == ERROR_OK) {
-		uint32_t val = get_buffer(target, buffer);
-		t->oncpu = val;
-	} else
-		LOG_ERROR("fill task: unable to read memory");
+	uint32_t val = get_buffer(target, buffer + MEM);
 
-	retval = fill_buffer(target, mem_addr, buffer);
+	if (val != 0) {
+		uint32_t asid_addr = val + MM_CTX;
 
-	if (retval == ERROR_OK) {
-		uint32_t val = get_buffer(target, buffer);
-
-		if (val != 0) {
-			uint32_t asid_addr = val + MM_CTX;
-			retval = fill_buffer(target, asid_addr, buffer);
-
-			if (retval == ERROR_OK) {
-				val = get_buffer(target, buffer);
-				t->asid = val;
-			} else
-				LOG_ERROR
-					("fill task: unable to read memory -- ASID");
+		if (fill_buffer(target, asid_addr, buffer) == ERROR_OK) {
+			val = get_buffer(target, buffer);
+			t->asid = val;
 		} else
-			t->asid = 0;
+			LOG_ERROR
+				("fill task: unable to read memory -- ASID");
 	} else
-		LOG_ERROR("fill task: unable to read memory");
+		t->asid = 0;
 
 	free(buffer);
 
-	return retval;
+	return ERROR_OK;
 }
 
 int get_name(struct target *target, struct threads *t)
@@ -459,7 +531,6 @@ int get_current(struct target *target, int create)
 					t = calloc(1, sizeof(struct threads));
 					t->base_addr = ct->TS;
 					fill_task(target, t);
-					get_name(target, t);
 					t->oncpu = cpu;
 					insert_into_threadlist(target, t);
 					t->status = 3;
@@ -700,6 +771,8 @@ int linux_get_tasks(struct target *target, int context)
 
 	int64_t start = timeval_ms();
 
+	linux_invalidate_tlb(linux_os);
+
 	struct threads *t = calloc(1, sizeof(struct threads));
 	struct threads *last = NULL;
 	t->base_addr = linux_os->init_task_addr;
@@ -709,8 +782,7 @@ int linux_get_tasks(struct target *target, int context)
 	while (((t->base_addr != linux_os->init_task_addr) &&
 		(t->base_addr != 0)) || (loop == 0)) {
 		loop++;
-		fill_task(target, t);
-		retval = get_name(target, t);
+		retval = fill_task(target, t);
 
 		if (loop > MAX_THREADS) {
 			free(t);
@@ -874,7 +946,6 @@ error_handling:
 				if (fill_task(target, t) != ERROR_OK)
 					goto error_handling;
 
-				get_name(target, t);
 				insert_into_threadlist(target, t);
 				t->thread_info_addr = 0xdeadbeef;
 			}
@@ -1013,7 +1084,6 @@ static int linux_task_update(struct target *target, int context)
 		if (found == 0) {
 			uint32_t base_addr;
 			fill_task(target, t);
-			get_name(target, t);
 			retval = insert_into_threadlist(target, t);
 			t->thread_info_addr = 0xdeadbeef;
 
@@ -1421,6 +1491,7 @@ static int linux_os_smp_init(struct target *target)
 			os_linux->current_threads =
 				add_current_thread(os_linux->current_threads, ct);
 			os_linux->nr_cpus++;
+			target_unregister_event_callback(linux_event_handler, smp_os_linux);
 			free(smp_os_linux);
 		}
 
@@ -1456,9 +1527,31 @@ static int linux_os_create(struct target *target)
 	/*  initialize a default virt 2 phys translation */
 	os_linux->phys_mask = ~0xc0000000;
 	os_linux->phys_base = 0x0;
+	linux_invalidate_tlb(os_linux);
+	target_register_event_callback(linux_event_handler, os_linux);
 	return JIM_OK;
 }
 
+static void linux_os_destroy(struct target *target)
+{
+	struct linux_os *os_linux = target->rtos->rtos_specific_params;
+
+	if (!os_linux)
+		return;
+
+	target_unregister_event_callback(linux_event_handler, os_linux);
+	clean_threadlist(target);
+
+	while (os_linux->current_threads) {
+		struct current_thread *ct = os_linux->current_threads;
+		os_linux->current_threads = ct->next;
+		free(ct);
+	}
+
+	free(os_linux);
+	target->rtos->rtos_specific_params = NULL;
+}
+
 static char *linux_ps_command(struct target *target)
 {
 	struct linux_os *linux_os = (struct linux_os *)
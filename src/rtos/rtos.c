@@ -68,6 +68,77 @@ static int rtos_target_for_threadid(struct connection *connection, int64_t threa
 	return ERROR_OK;
 }
 
+/* Register list of one thread, valid until the target runs again */
+struct rtos_thread_regs {
+	int64_t threadid;
+	struct rtos_reg *reg_list;
+	int num_regs;
+};
+
+static void rtos_free_thread_regs(struct rtos *os)
+{
+	for (int i = 0; i < os->thread_regs_count; i++)
+		free(os->thread_regs[i].reg_list);
+	free(os->thread_regs);
+	os->thread_regs = NULL;
+	os->thread_regs_count = 0;
+}
+
+static int rtos_event_handler(struct target *target, enum target_event event, void *priv)
+{
+	struct rtos *os = priv;
+
+	if (target->rtos != os)
+		return ERROR_OK;
+
+	switch (event) {
+	case TARGET_EVENT_HALTED:
+	case TARGET_EVENT_RESUMED:
+	case TARGET_EVENT_RESET_ASSERT:
+		rtos_free_thread_regs(os);
+		break;
+	default:
+		break;
+	}
+
+	return ERROR_OK;
+}
+
+/*
+ * Get the registers of a thread other than the running one. Each thread's
+ * registers are read from its stack once per stop, GDB tends to ask for
+ * them repeatedly and one register at a time. The list belongs to the
+ * cache, do not free it.
+ */
+static int rtos_get_thread_reg_list(struct rtos *os, int64_t threadid,
+		struct rtos_reg **reg_list, int *num_regs)
+{
+	for (int i = 0; i < os->thread_regs_count; i++) {
+		if (os->thread_regs[i].threadid == threadid) {
+			*reg_list = os->thread_regs[i].reg_list;
+			*num_regs = os->thread_regs[i].num_regs;
+			return ERROR_OK;
+		}
+	}
+
+	struct rtos_thread_regs *thread_regs = realloc(os->thread_regs,
+			(os->thread_regs_count + 1) * sizeof(*thread_regs));
+	if (!thread_regs)
+		return ERROR_FAIL;
+	os->thread_regs = thread_regs;
+
+	int retval = os->type->get_thread_reg_list(os, threadid, reg_list, num_regs);
+	if (retval != ERROR_OK)
+		return retval;
+
+	thread_regs += os->thread_regs_count++;
+	thread_regs->threadid = threadid;
+	thread_regs->reg_list = *reg_list;
+	thread_regs->num_regs = *num_regs;
+
+	return ERROR_OK;
+}
+
 static int os_alloc(struct target *target, struct rtos_type *ostype)
 {
 	struct rtos *os = target->rtos = calloc(1, sizeof(struct rtos));
@@ -85,6 +156,8 @@ static int os_alloc(struct target *target, struct rtos_type *ostype)
 	os->gdb_thread_packet = rtos_thread_packet;
 	os->gdb_target_for_threadid = rtos_target_for_threadid;
 
+	target_register_event_callback(rtos_event_handler, os);
+
 	return JIM_OK;
 }
 
@@ -93,9 +166,15 @@ static void os_free(struct target *target)
 	if (!target->rtos)
 		return;
 
+	if (target->rtos->type->destroy)
+		target->rtos->type->destroy(target);
+
 	if (target->rtos->symbols)
 		free(target->rtos->symbols);
 
+	target_unregister_event_callback(rtos_event_handler, target->rtos);
+	rtos_free_thread_regs(target->rtos);
+
 	free(target->rtos);
 	target->rtos = NULL;
 }
@@ -475,7 +554,7 @@ int rtos_get_gdb_reg(struct connection *connection, int reg_num)
 										current_threadid,
 										target->rtos->current_thread);
 
-		int retval = target->rtos->type->get_thread_reg_list(target->rtos,
+		int retval = rtos_get_thread_reg_list(target->rtos,
 				current_threadid,
 				&reg_list,
 				&num_regs);
@@ -487,12 +566,9 @@ int rtos_get_gdb_reg(struct connection *connection, int reg_num)
 		for (int i = 0; i < num_regs; ++i) {
 			if (reg_list[i].number == (uint32_t)reg_num) {
 				rtos_put_gdb_reg_list(connection, reg_list + i, 1);
-				free(reg_list);
 				return ERROR_OK;
 			}
 		}
-
-		free(reg_list);
 	}
 	return ERROR_FAIL;
 }
@@ -513,7 +589,7 @@ int rtos_get_gdb_reg_list(struct connection *connection)
 										current_threadid,
 										target->rtos->current_thread);
 
-		int retval = target->rtos->type->get_thread_reg_list(target->rtos,
+		int retval = rtos_get_thread_reg_list(target->rtos,
 				current_threadid,
 				&reg_list,
 				&num_regs);
@@ -523,7 +599,6 @@ int rtos_get_gdb_reg_list(struct connection *connection)
 		}
 
 		rtos_put_gdb_reg_list(connection, reg_list, num_regs);
-		free(reg_list);
 
 		return ERROR_OK;
 	}
@@ -616,8 +691,10 @@ int rtos_try_next(struct target *target)
 
 int rtos_update_threads(struct target *target)
 {
-	if ((target->rtos != NULL) && (target->rtos->type != NULL))
+	if ((target->rtos != NULL) && (target->rtos->type != NULL)) {
+		rtos_free_thread_regs(target->rtos);
 		target->rtos->type->update_threads(target->rtos);
+	}
 	return ERROR_OK;
 }
 
@@ -53,6 +53,9 @@ struct rtos {
 	threadid_t current_thread;
 	struct thread_detail *thread_details;
 	int thread_count;
+	/* registers of other threads read since the last stop */
+	struct rtos_thread_regs *thread_regs;
+	int thread_regs_count;
 	int (*gdb_thread_packet)(struct connection *connection, char const *packet, int packet_size);
 	int (*gdb_target_for_threadid)(struct connection *connection, int64_t thread_id, struct target **p_target);
 	void *rtos_specific_params;
@@ -75,6 +78,8 @@ struct rtos_type {
 	int (*get_symbol_list_to_lookup)(symbol_table_elem_t *symbol_list[]);
 	int (*clean)(struct target *target);
 	char * (*ps_command)(struct target *target);
+	/* optional, releases what create() set up when the rtos is torn down */
+	void (*destroy)(struct target *target);
 };
 
 struct stack_register_offset {
@@ -0,0 +1,679 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by the OpenOCD developers                          *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <helper/log.h>
+#include <helper/perf.h>
+#include <helper/time_support.h>
+#include <target/target.h>
+
+#include "rtt.h"
+
+/*
+ * Layout of the control block in target memory:
+ *
+ *   char id[16];
+ *   int32_t max_up_channels;
+ *   int32_t max_down_channels;
+ *   struct channel up[max_up_channels];
+ *   struct channel down[max_down_channels];
+ *
+ * with each channel described by six 32-bit words: name, buffer, size,
+ * write offset, read offset and flags. The writer of a channel owns the
+ * write offset, the reader the read offset.
+ */
+#define RTT_CB_HEADER_SIZE		24
+#define RTT_CHANNEL_SIZE		24
+#define RTT_CHANNEL_WRITE_OFFSET	12
+#define RTT_CHANNEL_READ_OFFSET		16
+
+/* channel buffers larger than this are taken as a corrupt control block,
+ * as they would be read from a timer callback */
+#define RTT_MAX_BUFFER_SIZE		(1024 * 1024)
+
+/* memory is searched for the control block in chunks of this size */
+#define RTT_SCAN_CHUNK_SIZE		1024
+
+/* a search that came up empty is repeated no sooner than this, in ms */
+#define RTT_SCAN_INTERVAL		1000
+
+#define RTT_DEFAULT_POLLING_INTERVAL	100
+
+struct rtt_channel {
+	uint32_t name;
+	uint32_t buffer;
+	uint32_t size;
+	uint32_t write_offset;
+	uint32_t read_offset;
+	uint32_t flags;
+};
+
+struct rtt_sink {
+	rtt_sink_read read;
+	void *user_data;
+	struct rtt_sink *next;
+};
+
+static struct {
+	/* memory range searched for the control block, and its identifier */
+	target_addr_t address;
+	uint32_t size;
+	char id[RTT_CB_MAX_ID_LENGTH];
+	bool configured;
+
+	struct target *target;
+	bool started;
+
+	/* location and channel counts of the control block, once found */
+	bool found;
+	int64_t next_scan_us;
+	target_addr_t cb_address;
+	uint32_t num_up;
+	uint32_t num_down;
+
+	struct rtt_sink *sinks[RTT_MAX_CHANNELS];
+	unsigned int polling_interval;
+
+	/* holds the control block and the data read from up channels */
+	uint8_t *buffer;
+	uint32_t buffer_size;
+} rtt = {
+	.id = RTT_CB_DEFAULT_ID,
+	.polling_interval = RTT_DEFAULT_POLLING_INTERVAL,
+};
+
+static uint8_t *rtt_get_buffer(uint32_t size)
+{
+	if (size > rtt.buffer_size) {
+		uint8_t *buffer = realloc(rtt.buffer, size);
+		if (buffer == NULL)
+			return NULL;
+		rtt.buffer = buffer;
+		rtt.buffer_size = size;
+	}
+
+	return rtt.buffer;
+}
+
+static void rtt_parse_channel(struct rtt_channel *channel, const uint8_t *buf)
+{
+	struct target *target = rtt.target;
+
+	channel->name = target_buffer_get_u32(target, buf);
+	channel->buffer = target_buffer_get_u32(target, buf + 4);
+	channel->size = target_buffer_get_u32(target, buf + 8);
+	channel->write_offset = target_buffer_get_u32(target, buf + RTT_CHANNEL_WRITE_OFFSET);
+	channel->read_offset = target_buffer_get_u32(target, buf + RTT_CHANNEL_READ_OFFSET);
+	channel->flags = target_buffer_get_u32(target, buf + 20);
+}
+
+static bool rtt_channel_is_valid(const struct rtt_channel *channel)
+{
+	return channel->buffer != 0 && channel->size != 0 &&
+		channel->size <= RTT_MAX_BUFFER_SIZE &&
+		channel->write_offset < channel->size &&
+		channel->read_offset < channel->size;
+}
+
+static target_addr_t rtt_channel_address(unsigned int index)
+{
+	return rtt.cb_address + RTT_CB_HEADER_SIZE + index * RTT_CHANNEL_SIZE;
+}
+
+/* Check the identifier and channel counts at the start of @a buf */
+static int rtt_parse_header(const uint8_t *buf, uint32_t *num_up, uint32_t *num_down)
+{
+	if (strncmp((const char *)buf, rtt.id, RTT_CB_MAX_ID_LENGTH))
+		return ERROR_FAIL;
+
+	*num_up = target_buffer_get_u32(rtt.target, buf + RTT_CB_MAX_ID_LENGTH);
+	*num_down = target_buffer_get_u32(rtt.target, buf + RTT_CB_MAX_ID_LENGTH + 4);
+
+	if (*num_up > RTT_MAX_CHANNELS || *num_down > RTT_MAX_CHANNELS)
+		return ERROR_FAIL;
+
+	return ERROR_OK;
+}
+
+static int rtt_find_control_block(void)
+{
+	size_t id_length = strlen(rtt.id);
+	uint8_t *buf = rtt_get_buffer(RTT_SCAN_CHUNK_SIZE + id_length);
+	uint8_t header[RTT_CB_HEADER_SIZE];
+	int retval;
+
+	if (buf == NULL)
+		return ERROR_FAIL;
+
+	for (uint32_t offset = 0; offset < rtt.size; offset += RTT_SCAN_CHUNK_SIZE) {
+		/* chunks overlap so that an identifier crossing a boundary is found */
+		uint32_t length = MIN(rtt.size - offset, RTT_SCAN_CHUNK_SIZE + id_length - 1);
+
+		retval = target_read_buffer(rtt.target, rtt.address + offset, length, buf);
+		if (retval != ERROR_OK)
+			return retval;
+
+		for (uint32_t i = 0; i + id_length <= length; i++) {
+			if (buf[i] != rtt.id[0] || memcmp(buf + i, rtt.id, id_length))
+				continue;
+
+			target_addr_t address = rtt.address + offset + i;
+
+			retval = target_read_buffer(rtt.target, address, sizeof(header), header);
+			if (retval != ERROR_OK)
+				return retval;
+
+			if (rtt_parse_header(header, &rtt.num_up, &rtt.num_down) != ERROR_OK)
+				continue;
+
+			rtt.cb_address = address;
+			rtt.found = true;
+
+			LOG_INFO("rtt: control block found at " TARGET_ADDR_FMT
+				", %" PRIu32 " up and %" PRIu32 " down channels",
+				address, rtt.num_up, rtt.num_down);
+
+			return ERROR_OK;
+		}
+	}
+
+	return ERROR_FAIL;
+}
+
+/* Rate limited rtt_find_control_block(), scanning a whole RAM range every
+ * poll would keep the adapter busy until the firmware sets up RTT */
+static int rtt_search_control_block(void)
+{
+	int64_t now = monotonic_us();
+	int retval;
+
+	if (now < rtt.next_scan_us)
+		return ERROR_FAIL;
+
+	retval = rtt_find_control_block();
+	if (retval != ERROR_OK)
+		rtt.next_scan_us = now + RTT_SCAN_INTERVAL * 1000LL;
+
+	return retval;
+}
+
+/* Hand new data of up channel @a index to its sinks */
+static int rtt_read_up_channel(unsigned int index, const struct rtt_channel *channel,
+		uint32_t *bytes)
+{
+	uint32_t read_offset = channel->read_offset;
+	uint32_t write_offset = channel->write_offset;
+	uint32_t first, second;
+	uint8_t *buf;
+	int retval;
+
+	if (!rtt_channel_is_valid(channel) || read_offset == write_offset)
+		return ERROR_OK;
+
+	/* the data may wrap around the end of the buffer */
+	if (write_offset > read_offset) {
+		first = write_offset - read_offset;
+		second = 0;
+	} else {
+		first = channel->size - read_offset;
+		second = write_offset;
+	}
+
+	buf = rtt_get_buffer(first + second);
+	if (buf == NULL)
+		return ERROR_FAIL;
+
+	retval = target_read_buffer(rtt.target, channel->buffer + read_offset, first, buf);
+	if (retval != ERROR_OK)
+		return retval;
+
+	if (second) {
+		retval = target_read_buffer(rtt.target, channel->buffer, second, buf + first);
+		if (retval != ERROR_OK)
+			return retval;
+	}
+
+	retval = target_write_u32(rtt.target,
+			rtt_channel_address(index) + RTT_CHANNEL_READ_OFFSET, write_offset);
+	if (retval != ERROR_OK)
+		return retval;
+
+	for (struct rtt_sink *sink = rtt.sinks[index]; sink; sink = sink->next)
+		sink->read(index, buf, first + second, sink->user_data);
+
+	*bytes += first + second;
+
+	return ERROR_OK;
+}
+
+static int rtt_poll(void *priv)
+{
+	static struct perf_stat poll_stat = PERF_STAT_INIT("rtt.poll");
+	struct rtt_channel channels[RTT_MAX_CHANNELS];
+	uint32_t num_up, num_down;
+	unsigned int count = 0;
+	uint32_t bytes = 0;
+	uint8_t *buf;
+	int retval;
+
+	if (!rtt.started)
+		return ERROR_OK;
+
+	if (rtt.target->state != TARGET_RUNNING && rtt.target->state != TARGET_HALTED)
+		return ERROR_OK;
+
+	if (!rtt.found && rtt_search_control_block() != ERROR_OK)
+		return ERROR_OK;
+
+	/* only channels up to the last one somebody listens to are read */
+	for (unsigned int i = 0; i < rtt.num_up; i++) {
+		if (rtt.sinks[i])
+			count = i + 1;
+	}
+
+	if (count == 0)
+		return ERROR_OK;
+
+	int64_t start = perf_start();
+
+	/* the header and channel descriptors in one go */
+	buf = rtt_get_buffer(RTT_CB_HEADER_SIZE + count * RTT_CHANNEL_SIZE);
+	if (buf == NULL)
+		return ERROR_FAIL;
+
+	retval = target_read_buffer(rtt.target, rtt.cb_address,
+			RTT_CB_HEADER_SIZE + count * RTT_CHANNEL_SIZE, buf);
+	if (retval != ERROR_OK)
+		goto out;
+
+	if (rtt_parse_header(buf, &num_up, &num_down) != ERROR_OK ||
+			num_up != rtt.num_up || num_down != rtt.num_down) {
+		/* e.g. the target was reset and the firmware has not set it up yet */
+		LOG_DEBUG("rtt: control block lost, searching again");
+		rtt.found = false;
+		goto out;
+	}
+
+	for (unsigned int i = 0; i < count; i++)
+		rtt_parse_channel(&channels[i], buf + RTT_CB_HEADER_SIZE + i * RTT_CHANNEL_SIZE);
+
+	for (unsigned int i = 0; i < count; i++) {
+		if (!rtt.sinks[i])
+			continue;
+
+		retval = rtt_read_up_channel(i, &channels[i], &bytes);
+		if (retval != ERROR_OK)
+			break;
+	}
+
+out:
+	if (bytes)
+		target_timer_callback_active();
+
+	perf_end(&poll_stat, start, count, bytes, retval);
+
+	return retval;
+}
+
+int rtt_write_channel(unsigned int channel, const uint8_t *buffer, size_t *length)
+{
+	struct rtt_channel down;
+	uint8_t buf[RTT_CHANNEL_SIZE];
+	uint32_t space, first;
+	int retval;
+
+	if (!rtt.started || !rtt.found) {
+		*length = 0;
+		return ERROR_FAIL;
+	}
+
+	if (channel >= rtt.num_down) {
+		LOG_WARNING("rtt: down channel %u not available", channel);
+		*length = 0;
+		return ERROR_FAIL;
+	}
+
+	target_addr_t address = rtt_channel_address(rtt.num_up + channel);
+
+	retval = target_read_buffer(rtt.target, address, sizeof(buf), buf);
+	if (retval != ERROR_OK)
+		return retval;
+
+	rtt_parse_channel(&down, buf);
+
+	if (!rtt_channel_is_valid(&down)) {
+		*length = 0;
+		return ERROR_FAIL;
+	}
+
+	/* one byte always stays free, so that full and empty can be told apart */
+	if (down.read_offset > down.write_offset)
+		space = down.read_offset - down.write_offset - 1;
+	else
+		space = down.size - down.write_offset + down.read_offset - 1;
+
+	*length = MIN(*length, space);
+	if (*length == 0)
+		return ERROR_OK;
+
+	first = MIN(*length, down.size - down.write_offset);
+
+	retval = target_write_buffer(rtt.target, down.buffer + down.write_offset, first, buffer);
+	if (retval != ERROR_OK)
+		return retval;
+
+	if (*length > first) {
+		retval = target_write_buffer(rtt.target, down.buffer, *length - first, buffer + first);
+		if (retval != ERROR_OK)
+			return retval;
+	}
+
+	return target_write_u32(rtt.target, address + RTT_CHANNEL_WRITE_OFFSET,
+			(down.write_offset + *length) % down.size);
+}
+
+int rtt_register_sink(unsigned int channel, rtt_sink_read read, void *user_data)
+{
+	struct rtt_sink *sink;
+
+	if (channel >= RTT_MAX_CHANNELS)
+		return ERROR_COMMAND_ARGUMENT_INVALID;
+
+	sink = malloc(sizeof(*sink));
+	if (sink == NULL)
+		return ERROR_FAIL;
+
+	sink->read = read;
+	sink->user_data = user_data;
+	sink->next = rtt.sinks[channel];
+	rtt.sinks[channel] = sink;
+
+	return ERROR_OK;
+}
+
+int rtt_unregister_sink(unsigned int channel, rtt_sink_read read, void *user_data)
+{
+	if (channel >= RTT_MAX_CHANNELS)
+		return ERROR_COMMAND_ARGUMENT_INVALID;
+
+	for (struct rtt_sink **p = &rtt.sinks[channel]; *p; p = &(*p)->next) {
+		struct rtt_sink *sink = *p;
+		if (sink->read == read && sink->user_data == user_data) {
+			*p = sink->next;
+			free(sink);
+			return ERROR_OK;
+		}
+	}
+
+	return ERROR_OK;
+}
+
+bool rtt_started(void)
+{
+	return rtt.started && rtt.found;
+}
+
+static void rtt_stop(void)
+{
+	if (rtt.started)
+		target_unregister_timer_callback(rtt_poll, NULL);
+
+	rtt.started = false;
+	rtt.found = false;
+}
+
+void rtt_exit(void)
+{
+	rtt_stop();
+
+	for (unsigned int i = 0; i < RTT_MAX_CHANNELS; i++) {
+		while (rtt.sinks[i]) {
+			struct rtt_sink *sink = rtt.sinks[i];
+			rtt.sinks[i] = sink->next;
+			free(sink);
+		}
+	}
+
+	free(rtt.buffer);
+	rtt.buffer = NULL;
+	rtt.buffer_size = 0;
+}
+
+COMMAND_HANDLER(handle_rtt_setup_command)
+{
+	if (CMD_ARGC < 2 || CMD_ARGC > 3)
+		return ERROR_COMMAND_SYNTAX_ERROR;
+
+	target_addr_t address;
+	uint32_t size;
+	const char *id = RTT_CB_DEFAULT_ID;
+
+	COMMAND_PARSE_ADDRESS(CMD_ARGV[0], address);
+	COMMAND_PARSE_NUMBER(u32, CMD_ARGV[1], size);
+
+	if (CMD_ARGC == 3)
+		id = CMD_ARGV[2];
+
+	if (strlen(id) == 0 || strlen(id) >= RTT_CB_MAX_ID_LENGTH) {
+		command_print(CMD_CTX, "control block identifier must be 1 to %d characters",
+			RTT_CB_MAX_ID_LENGTH - 1);
+		return ERROR_COMMAND_ARGUMENT_INVALID;
+	}
+
+	rtt_stop();
+
+	rtt.address = address;
+	rtt.size = size;
+	memset(rtt.id, 0, sizeof(rtt.id));
+	strcpy(rtt.id, id);
+	rtt.configured = true;
+
+	return ERROR_OK;
+}
+
+COMMAND_HANDLER(handle_rtt_start_command)
+{
+	int retval;
+
+	if (CMD_ARGC != 0)
+		return ERROR_COMMAND_SYNTAX_ERROR;
+
+	if (!rtt.configured) {
+		command_print(CMD_CTX, "rtt is not configured, see 'rtt setup'");
+		return ERROR_FAIL;
+	}
+
+	if (rtt.started)
+		return ERROR_OK;
+
+	rtt.target = get_current_target(CMD_CTX);
+	rtt.found = false;
+	rtt.next_scan_us = 0;
+
+	retval = target_register_adaptive_timer_callback(rtt_poll, rtt.polling_interval, NULL);
+	if (retval != ERROR_OK)
+		return retval;
+
+	rtt.started = true;
+
+	/* the firmware may set up the control block later, polling keeps looking */
+	if (rtt_search_control_block() != ERROR_OK)
+		command_print(CMD_CTX, "rtt: no control block found yet, searching while polling");
+
+	return ERROR_OK;
+}
+
+COMMAND_HANDLER(handle_rtt_stop_command)
+{
+	if (CMD_ARGC != 0)
+		return ERROR_COMMAND_SYNTAX_ERROR;
+
+	rtt_stop();
+
+	return ERROR_OK;
+}
+
+COMMAND_HANDLER(handle_rtt_polling_interval_command)
+{
+	if (CMD_ARGC > 1)
+		return ERROR_COMMAND_SYNTAX_ERROR;
+
+	if (CMD_ARGC == 1) {
+		unsigned int interval;
+
+		COMMAND_PARSE_NUMBER(uint, CMD_ARGV[0], interval);
+		if (interval == 0)
+			return ERROR_COMMAND_ARGUMENT_INVALID;
+
+		rtt.polling_interval = interval;
+
+		if (rtt.started) {
+			target_unregister_timer_callback(rtt_poll, NULL);
+			int retval = target_register_adaptive_timer_callback(rtt_poll,
+					rtt.polling_interval, NULL);
+			if (retval != ERROR_OK)
+				return retval;
+		}
+	}
+
+	command_print(CMD_CTX, "rtt polling interval: %u ms", rtt.polling_interval);
+
+	return ERROR_OK;
+}
+
+static void rtt_read_channel_name(const struct rtt_channel *channel, char *name)
+{
+	uint8_t buf[RTT_CHANNEL_NAME_LENGTH];
+
+	name[0] = '\0';
+
+	if (channel->name == 0 ||
+			target_read_buffer(rtt.target, channel->name, sizeof(buf), buf) != ERROR_OK)
+		return;
+
+	for (unsigned int i = 0; i < sizeof(buf) - 1 && isprint(buf[i]); i++) {
+		name[i] = buf[i];
+		name[i + 1] = '\0';
+	}
+}
+
+COMMAND_HANDLER(handle_rtt_channels_command)
+{
+	struct rtt_channel channel;
+	char name[RTT_CHANNEL_NAME_LENGTH];
+	uint8_t *buf;
+	int retval;
+
+	if (CMD_ARGC != 0)
+		return ERROR_COMMAND_SYNTAX_ERROR;
+
+	if (!rtt_started()) {
+		command_print(CMD_CTX, "rtt is not started or no control block was found");
+		return ERROR_FAIL;
+	}
+
+	uint32_t length = (rtt.num_up + rtt.num_down) * RTT_CHANNEL_SIZE;
+
+	buf = malloc(length);
+	if (buf == NULL)
+		return ERROR_FAIL;
+
+	retval = target_read_buffer(rtt.target, rtt_channel_address(0), length, buf);
+	if (retval != ERROR_OK) {
+		free(buf);
+		return retval;
+	}
+
+	for (unsigned int i = 0; i < rtt.num_up + rtt.num_down; i++) {
+		bool up = i < rtt.num_up;
+
+		if (i == 0 || i == rtt.num_up)
+			command_print(CMD_CTX, "%s channels:", up ? "up" : "down");
+
+		rtt_parse_channel(&channel, buf + i * RTT_CHANNEL_SIZE);
+		if (!rtt_channel_is_valid(&channel))
+			continue;
+
+		rtt_read_channel_name(&channel, name);
+		command_print(CMD_CTX, "%2u: %-20s size: %" PRIu32 ", flags: 0x%" PRIx32,
+			up ? i : i - rtt.num_up, name, channel.size, channel.flags);
+	}
+
+	free(buf);
+
+	return ERROR_OK;
+}
+
+static const struct command_registration rtt_subcommand_handlers[] = {
+	{
+		.name = "setup",
+		.handler = handle_rtt_setup_command,
+		.mode = COMMAND_ANY,
+		.help = "set the memory range searched for the control block, "
+			"and its identifier",
+		.usage = "address size [ID]",
+	},
+	{
+		.name = "start",
+		.handler = handle_rtt_start_command,
+		.mode = COMMAND_EXEC,
+		.help = "find the control block and start polling the channels",
+		.usage = "",
+	},
+	{
+		.name = "stop",
+		.handler = handle_rtt_stop_command,
+		.mode = COMMAND_EXEC,
+		.help = "stop polling the channels",
+		.usage = "",
+	},
+	{
+		.name = "polling_interval",
+		.handler = handle_rtt_polling_interval_command,
+		.mode = COMMAND_ANY,
+		.help = "display or set the longest channel polling interval, "
+			"used while there is no traffic",
+		.usage = "[milliseconds]",
+	},
+	{
+		.name = "channels",
+		.handler = handle_rtt_channels_command,
+		.mode = COMMAND_EXEC,
+		.help = "list the channels of the control block",
+		.usage = "",
+	},
+	COMMAND_REGISTRATION_DONE
+};
+
+static const struct command_registration rtt_command_handlers[] = {
+	{
+		.name = "rtt",
+		.mode = COMMAND_ANY,
+		.help = "Real Time Transfer channels",
+		.usage = "",
+		.chain = rtt_subcommand_handlers,
+	},
+	COMMAND_REGISTRATION_DONE
+};
+
+int rtt_register_commands(struct command_context *cmd_ctx)
+{
+	return register_commands(cmd_ctx, NULL, rtt_command_handlers);
+}
@@ -0,0 +1,70 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by the OpenOCD developers                          *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#ifndef OPENOCD_RTT_RTT_H
+#define OPENOCD_RTT_RTT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <helper/command.h>
+#include <target/target.h>
+
+/**
+ * @file
+ * Real Time Transfer: ring buffers in target RAM, described by a control
+ * block the target firmware sets up, that are read and written by the
+ * debugger while the target keeps running.
+ */
+
+/** Default identifier at the start of the control block */
+#define RTT_CB_DEFAULT_ID	"SEGGER RTT"
+/** Maximum length of the control block identifier, including the NUL */
+#define RTT_CB_MAX_ID_LENGTH	16
+/** Maximum length of a channel name read from the target */
+#define RTT_CHANNEL_NAME_LENGTH	32
+/** Channel numbers are below this, more are taken as a corrupt control block */
+#define RTT_MAX_CHANNELS	32
+
+/** Called with data read from an up (target to host) channel */
+typedef int (*rtt_sink_read)(unsigned int channel, const uint8_t *buffer,
+		size_t length, void *user_data);
+
+int rtt_register_commands(struct command_context *cmd_ctx);
+
+/**
+ * Register @a read to be called with the data of up channel @a channel.
+ * Only channels with a sink are read from the target.
+ */
+int rtt_register_sink(unsigned int channel, rtt_sink_read read, void *user_data);
+int rtt_unregister_sink(unsigned int channel, rtt_sink_read read, void *user_data);
+
+/**
+ * Write to down (host to target) channel @a channel.
+ *
+ * @param length on input the number of bytes in @a buffer, on output the
+ * number of bytes written, which is less when the channel is full.
+ */
+int rtt_write_channel(unsigned int channel, const uint8_t *buffer, size_t *length);
+
+/** @returns true while RTT is started and its control block was found */
+bool rtt_started(void);
+
+/** Stop polling and release all RTT resources */
+void rtt_exit(void);
+
+#endif /* OPENOCD_RTT_RTT_H */
@@ -48,6 +48,7 @@
 #include "gdb_server.h"
 #include <target/image.h>
 #include <jtag/jtag.h>
+#include <helper/perf.h>
 #include "rtos/rtos.h"
 #include "target/smp.h"
 
@@ -3147,6 +3148,9 @@ static int gdb_input_inner(struct connection *connection)
 		/* terminate with zero */
 		gdb_packet_buffer[packet_size] = '\0';
 
+		static struct perf_stat packet_stat = PERF_STAT_INIT("gdb.packet");
+		int64_t packet_start = perf_start();
+
 		if (LOG_LEVEL_IS(LOG_LVL_DEBUG)) {
 			if (packet[0] == 'X') {
 				/* binary packets spew junk into the debug log stream */
@@ -3339,6 +3343,8 @@ static int gdb_input_inner(struct connection *connection)
 					break;
 			}
 
+			perf_end(&packet_stat, packet_start, 1, packet_size, retval);
+
 			/* if a packet handler returned an error, exit input loop */
 			if (retval != ERROR_OK)
 				return retval;
@@ -0,0 +1,175 @@
+/***************************************************************************
+ *   Copyright (C) 2026 by the OpenOCD developers                          *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <rtt/rtt.h>
+
+#include "server.h"
+#include "rtt_server.h"
+
+/**
+ * @file
+ * Serves RTT channels over TCP: data of an up channel goes to every
+ * client connected to the channel's port, data received from a client is
+ * written to the down channel with the same number.
+ */
+
+struct rtt_service {
+	unsigned int channel;
+};
+
+static int rtt_server_sink(unsigned int channel, const uint8_t *buffer,
+		size_t length, void *user_data)
+{
+	struct connection *connection = user_data;
+
+	if (connection_write(connection, buffer, length) < 0)
+		LOG_WARNING("rtt: dropped %zu bytes of channel %u", length, channel);
+
+	return ERROR_OK;
+}
+
+static int rtt_new_connection(struct connection *connection)
+{
+	struct rtt_service *service = connection->service->priv;
+
+	LOG_DEBUG("rtt: new connection for channel %u", service->channel);
+
+	return rtt_register_sink(service->channel, rtt_server_sink, connection);
+}
+
+static int rtt_connection_closed(struct connection *connection)
+{
+	struct rtt_service *service = connection->service->priv;
+
+	LOG_DEBUG("rtt: connection for channel %u closed", service->channel);
+
+	return rtt_unregister_sink(service->channel, rtt_server_sink, connection);
+}
+
+static int rtt_input(struct connection *connection)
+{
+	struct rtt_service *service = connection->service->priv;
+	uint8_t buffer[1024];
+	int bytes;
+
+	bytes = connection_read(connection, buffer, sizeof(buffer));
+	if (bytes <= 0) {
+		if (bytes < 0)
+			LOG_ERROR("error during read: %s", strerror(errno));
+		return ERROR_SERVER_REMOTE_CLOSED;
+	}
+
+	size_t length = bytes;
+	rtt_write_channel(service->channel, buffer, &length);
+
+	if (length < (size_t)bytes)
+		LOG_WARNING("rtt: down channel %u full, dropped %zu bytes",
+			service->channel, bytes - length);
+
+	return ERROR_OK;
+}
+
+COMMAND_HANDLER(handle_rtt_server_start_command)
+{
+	struct rtt_service *service;
+	unsigned int channel;
+	int retval;
+
+	if (CMD_ARGC != 2)
+		return ERROR_COMMAND_SYNTAX_ERROR;
+
+	COMMAND_PARSE_NUMBER(uint, CMD_ARGV[1], channel);
+
+	if (channel >= RTT_MAX_CHANNELS) {
+		command_print(CMD_CTX, "channel must be below %d", RTT_MAX_CHANNELS);
+		return ERROR_COMMAND_ARGUMENT_INVALID;
+	}
+
+	service = malloc(sizeof(*service));
+	if (service == NULL)
+		return ERROR_FAIL;
+
+	service->channel = channel;
+
+	/* once added, the service owns and frees its priv */
+	retval = add_service("rtt", CMD_ARGV[0], CONNECTION_LIMIT_UNLIMITED,
+			rtt_new_connection, rtt_input, rtt_connection_closed, service);
+	if (retval != ERROR_OK) {
+		free(service);
+		command_print(CMD_CTX, "failed to start RTT server on port %s", CMD_ARGV[0]);
+		return retval;
+	}
+
+	return ERROR_OK;
+}
+
+COMMAND_HANDLER(handle_rtt_server_stop_command)
+{
+	if (CMD_ARGC != 1)
+		return ERROR_COMMAND_SYNTAX_ERROR;
+
+	return remove_service("rtt", CMD_ARGV[0]);
+}
+
+static const struct command_registration rtt_server_subcommand_handlers[] = {
+	{
+		.name = "start",
+		.handler = handle_rtt_server_start_command,
+		.mode = COMMAND_ANY,
+		.help = "serve an RTT channel on a TCP port",
+		.usage = "port channel",
+	},
+	{
+		.name = "stop",
+		.handler = handle_rtt_server_stop_command,
+		.mode = COMMAND_ANY,
+		.help = "stop serving on a TCP port",
+		.usage = "port",
+	},
+	COMMAND_REGISTRATION_DONE
+};
+
+static const struct command_registration rtt_server_command_handlers[] = {
+	{
+		.name = "server",
+		.mode = COMMAND_ANY,
+		.help = "RTT channel servers",
+		.usage = "",
+		.chain = rtt_server_subcommand_handlers,
+	},
+	COMMAND_REGISTRATION_DONE
+};
+
+static const struct command_registration rtt_command_handlers[] = {
+	{
+		.name = "rtt",
+		.mode = COMMAND_ANY,
+		.help = "Real Time Transfer channels",
+		.usage = "",
+		.chain = rtt_server_command_handlers,
+	},
+	COMMAND_REGISTRATION_DONE
+};
+
+int rtt_server_register_commands(struct command_context *cmd_ctx)
+{
+	return register_commands(cmd_ctx, NULL, rtt_command_handlers);
+}
@@ -30,6 +30,7 @@
 #include <target/target.h>
 #include <target/target_request.h>
 #include <target/openrisc/jsp_server.h>
+#include <helper/time_support.h>
 #include "openocd.h"
 #include "tcl_server.h"
 #include "telnet_server.h"
@@ -77,6 +78,8 @@ static int add_connection(struct service *service, struct command_context *cmd_c
 	c->cmd_ctx = copy_command_context(cmd_ctx);
 	c->service = service;
 	c->input_pending = 0;
+	c->output_pending = 0;
+	c->output = NULL;
 	c->priv = NULL;
 	c->next = NULL;
 
@@ -436,6 +439,7 @@ int server_loop(struct command_context *command_context)
 
 	/* used in select() */
 	fd_set read_fds;
+	fd_set write_fds;
 	int fd_max;
 
 	/* used in accept() */
@@ -450,6 +454,7 @@ int server_loop(struct command_context *command_context)
 		/* monitor sockets for activity */
 		fd_max = 0;
 		FD_ZERO(&read_fds);
+		FD_ZERO(&write_fds);
 
 		/* add service and connection fds to read_fds */
 		for (service = services; service; service = service->next) {
@@ -469,6 +474,13 @@ int server_loop(struct command_context *command_context)
 					FD_SET(c->fd, &read_fds);
 					if (c->fd > fd_max)
 						fd_max = c->fd;
+
+					/* wait for room to drain queued output */
+					if (c->output_pending) {
+						FD_SET(c->fd_out, &write_fds);
+						if (c->fd_out > fd_max)
+							fd_max = c->fd_out;
+					}
 				}
 			}
 		}
@@ -479,14 +491,22 @@ int server_loop(struct command_context *command_context)
 			/* we're just polling this iteration, this is faster on embedded
 			 * hosts */
 			tv.tv_usec = 0;
-			retval = socket_select(fd_max + 1, &read_fds, NULL, NULL, &tv);
+			retval = socket_select(fd_max + 1, &read_fds, &write_fds, NULL, &tv);
 		} else {
-			/* Every 100ms, can be changed with "poll_period" command */
-			tv.tv_usec = polling_period * 1000;
+			/* Every 100ms, can be changed with "poll_period" command,
+			 * or earlier when a timer callback is due before that */
+			int64_t timeout_us = polling_period * 1000LL;
+			int64_t next_event_us = target_timer_next_event() - monotonic_us();
+			if (next_event_us < timeout_us)
+				timeout_us = next_event_us > 0 ? next_event_us : 0;
+			tv.tv_sec = timeout_us / 1000000;
+			tv.tv_usec = timeout_us % 1000000;
+			/* Nothing to do, write out pending debug output */
+			log_flush();
 			/* Only while we're sleeping we'll let others run */
 			openocd_sleep_prelude();
 			kept_alive();
-			retval = socket_select(fd_max + 1, &read_fds, NULL, NULL, &tv);
+			retval = socket_select(fd_max + 1, &read_fds, &write_fds, NULL, &tv);
 			openocd_sleep_postlude();
 		}
 
@@ -495,17 +515,19 @@ int server_loop(struct command_context *command_context)
 
 			errno = WSAGetLastError();
 
-			if (errno == WSAEINTR)
+			if (errno == WSAEINTR) {
 				FD_ZERO(&read_fds);
-			else {
+				FD_ZERO(&write_fds);
+			} else {
 				LOG_ERROR("error during select: %s", strerror(errno));
 				return ERROR_FAIL;
 			}
 #else
 
-			if (errno == EINTR)
+			if (errno == EINTR) {
 				FD_ZERO(&read_fds);
-			else {
+				FD_ZERO(&write_fds);
+			} else {
 				LOG_ERROR("error during select: %s", strerror(errno));
 				return ERROR_FAIL;
 			}
@@ -519,6 +541,7 @@ int server_loop(struct command_context *command_context)
 			process_jim_events(command_context);
 
 			FD_ZERO(&read_fds);	/* eCos leaves read_fds unchanged in this case!  */
+			FD_ZERO(&write_fds);
 
 			/* We timed out/there was nothing to do, timeout rather than poll next time
 			 **/
@@ -562,22 +585,25 @@ int server_loop(struct command_context *command_context)
 				struct connection *c;
 
 				for (c = service->connections; c; ) {
-					if ((FD_ISSET(c->fd, &read_fds)) || c->input_pending) {
+					retval = ERROR_OK;
+					if (c->output_pending && FD_ISSET(c->fd_out, &write_fds))
+						retval = c->output(c);
+					if (retval == ERROR_OK &&
+							((FD_ISSET(c->fd, &read_fds)) || c->input_pending))
 						retval = service->input(c);
-						if (retval != ERROR_OK) {
-							struct connection *next = c->next;
-							if (service->type == CONNECTION_PIPE ||
-									service->type == CONNECTION_STDINOUT) {
-								/* if connection uses a pipe then
-								 * shutdown openocd on error */
-								shutdown_openocd = SHUTDOWN_REQUESTED;
-							}
-							remove_connection(service, c);
-							LOG_INFO("dropped '%s' connection",
-								service->name);
-							c = next;
-							continue;
+					if (retval != ERROR_OK) {
+						struct connection *next = c->next;
+						if (service->type == CONNECTION_PIPE ||
+								service->type == CONNECTION_STDINOUT) {
+							/* if connection uses a pipe then
+							 * shutdown openocd on error */
+							shutdown_openocd = SHUTDOWN_REQUESTED;
 						}
+						remove_connection(service, c);
+						LOG_INFO("dropped '%s' connection",
+							service->name);
+						c = next;
+						continue;
 					}
 					c = c->next;
 				}
@@ -609,6 +635,10 @@ void sig_handler(int sig)
 		LOG_DEBUG("Terminating on Signal %d", sig);
 	} else
 		LOG_DEBUG("Ignored extra Signal %d", sig);
+
+	/* abort() terminates once we return, without running atexit() */
+	if (sig == SIGABRT)
+		log_emergency_flush();
 }
 
 
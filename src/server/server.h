@@ -50,6 +50,10 @@ struct connection {
 	struct command_context *cmd_ctx;
 	struct service *service;
 	int input_pending;
+	/* set while queued output waits for fd_out to become writable */
+	int output_pending;
+	/* called by server_loop() once fd_out is writable again */
+	int (*output)(struct connection *connection);
 	void *priv;
 	struct connection *next;
 };
@@ -27,6 +27,21 @@
 #define TCL_SERVER_VERSION		"TCL Server 0.1"
 #define TCL_LINE_INITIAL		(4*1024)
 #define TCL_LINE_MAX			(4*1024*1024)
+#define TCL_READ_SIZE			(4*1024)
+
+/* Binary mode frames start with this header, all fields little endian:
+ * u32 payload length, u32 request id, u8 type, 3 reserved bytes and
+ * i32 status (OpenOCD error code, responses only) */
+#define TCL_FRAME_HEADER_SIZE	16
+#define TCL_FRAME_MAX			(TCL_LINE_MAX - TCL_READ_SIZE - TCL_FRAME_HEADER_SIZE - 1)
+
+enum tcl_frame_type {
+	TCL_FRAME_COMMAND = 0,
+	TCL_FRAME_READ_MEMORY = 1,
+	TCL_FRAME_WRITE_MEMORY = 2,
+	TCL_FRAME_EVENT = 0x80,
+	TCL_FRAME_TRACE = 0x81,
+};
 
 struct tcl_connection {
 	int tc_linedrop;
@@ -37,6 +52,7 @@ struct tcl_connection {
 	enum target_state tc_laststate;
 	bool tc_notify;
 	bool tc_trace;
+	bool tc_binary;
 };
 
 static char *tcl_port;
@@ -45,8 +61,25 @@ static char *tcl_port;
 static int tcl_new_connection(struct connection *connection);
 static int tcl_input(struct connection *connection);
 static int tcl_output(struct connection *connection, const void *buf, ssize_t len);
+static int tcl_output_frame(struct connection *connection, uint8_t type,
+		uint32_t id, int status, const void *payload, size_t len);
 static int tcl_closed(struct connection *connection);
 
+/* push a notification, framed according to the connection's mode */
+static void tcl_output_event(struct connection *connection, const char *event)
+{
+	struct tcl_connection *tclc = connection->priv;
+
+	if (tclc->tc_binary) {
+		tcl_output_frame(connection, TCL_FRAME_EVENT, 0, ERROR_OK,
+				event, strlen(event));
+	} else {
+		char buf[512];
+		snprintf(buf, sizeof(buf), "%s\r\n\x1a", event);
+		tcl_output(connection, buf, strlen(buf));
+	}
+}
+
 static int tcl_target_callback_event_handler(struct target *target,
 		enum target_event event, void *priv)
 {
@@ -57,15 +90,15 @@ static int tcl_target_callback_event_handler(struct target *target,
 	tclc = connection->priv;
 
 	if (tclc->tc_notify) {
-		snprintf(buf, sizeof(buf), "type target_event event %s\r\n\x1a", target_event_name(event));
-		tcl_output(connection, buf, strlen(buf));
+		snprintf(buf, sizeof(buf), "type target_event event %s", target_event_name(event));
+		tcl_output_event(connection, buf);
 	}
 
 	if (tclc->tc_laststate != target->state) {
 		tclc->tc_laststate = target->state;
 		if (tclc->tc_notify) {
-			snprintf(buf, sizeof(buf), "type target_state state %s\r\n\x1a", target_state_name(target));
-			tcl_output(connection, buf, strlen(buf));
+			snprintf(buf, sizeof(buf), "type target_state state %s", target_state_name(target));
+			tcl_output_event(connection, buf);
 		}
 	}
 
@@ -82,8 +115,8 @@ static int tcl_target_callback_reset_handler(struct target *target,
 	tclc = connection->priv;
 
 	if (tclc->tc_notify) {
-		snprintf(buf, sizeof(buf), "type target_reset mode %s\r\n\x1a", target_reset_mode_name(reset_mode));
-		tcl_output(connection, buf, strlen(buf));
+		snprintf(buf, sizeof(buf), "type target_reset mode %s", target_reset_mode_name(reset_mode));
+		tcl_output_event(connection, buf);
 	}
 
 	return ERROR_OK;
@@ -102,7 +135,10 @@ static int tcl_target_callback_trace_handler(struct target *target,
 
 	tclc = connection->priv;
 
-	if (tclc->tc_trace) {
+	if (tclc->tc_trace && tclc->tc_binary) {
+		/* no need to hex encode in binary mode */
+		tcl_output_frame(connection, TCL_FRAME_TRACE, 0, ERROR_OK, data, len);
+	} else if (tclc->tc_trace) {
 		hex = malloc(hex_len);
 		buf = malloc(max_len);
 		hexify(hex, data, len, hex_len);
@@ -139,6 +175,30 @@ int tcl_output(struct connection *connection, const void *data, ssize_t len)
 	return ERROR_SERVER_REMOTE_CLOSED;
 }
 
+/* write out a binary mode frame */
+static int tcl_output_frame(struct connection *connection, uint8_t type,
+		uint32_t id, int status, const void *payload, size_t len)
+{
+	uint8_t *frame = malloc(TCL_FRAME_HEADER_SIZE + len);
+	int retval;
+
+	if (frame == NULL)
+		return ERROR_FAIL;
+
+	h_u32_to_le(frame, len);
+	h_u32_to_le(frame + 4, id);
+	frame[8] = type;
+	frame[9] = frame[10] = frame[11] = 0;
+	h_u32_to_le(frame + 12, status);
+	if (len)
+		memcpy(frame + TCL_FRAME_HEADER_SIZE, payload, len);
+
+	retval = tcl_output(connection, frame, TCL_FRAME_HEADER_SIZE + len);
+	free(frame);
+
+	return retval;
+}
+
 /* connections */
 static int tcl_new_connection(struct connection *connection)
 {
@@ -171,89 +231,219 @@ static int tcl_new_connection(struct connection *connection)
 	return ERROR_OK;
 }
 
-static int tcl_input(struct connection *connection)
+/* make room for @a len more bytes, plus a terminating NUL */
+static int tcl_line_reserve(struct tcl_connection *tclc, int len)
+{
+	int needed = tclc->tc_lineoffset + len + 1;
+	int tc_line_size_new = tclc->tc_line_size;
+	char *tc_line_new;
+
+	if (needed <= tclc->tc_line_size)
+		return ERROR_OK;
+
+	if (needed > TCL_LINE_MAX)
+		return ERROR_FAIL;
+
+	/* grow line buffer: exponential below 1 MB, linear above */
+	while (tc_line_size_new < needed) {
+		if (tc_line_size_new <= 1*1024*1024)
+			tc_line_size_new *= 2;
+		else
+			tc_line_size_new += 1*1024*1024;
+	}
+
+	if (tc_line_size_new > TCL_LINE_MAX)
+		tc_line_size_new = TCL_LINE_MAX;
+
+	tc_line_new = realloc(tclc->tc_line, tc_line_size_new);
+	if (tc_line_new == NULL)
+		return ERROR_FAIL;
+
+	tclc->tc_line = tc_line_new;
+	tclc->tc_line_size = tc_line_size_new;
+	return ERROR_OK;
+}
+
+static int tcl_run_line(struct connection *connection, char *line)
 {
 	Jim_Interp *interp = (Jim_Interp *)connection->cmd_ctx->interp;
+	struct tcl_connection *tclc = connection->priv;
+	const char *result;
+	int reslen;
 	int retval;
-	int i;
-	ssize_t rlen;
+
+	if (tclc->tc_linedrop) {
+#define ESTR "line too long\n"
+		retval = tcl_output(connection, ESTR, sizeof(ESTR));
+		tclc->tc_linedrop = 0;
+		return retval;
+#undef ESTR
+	}
+
+	command_run_line(connection->cmd_ctx, line);
+	result = Jim_GetString(Jim_GetResult(interp), &reslen);
+	retval = tcl_output(connection, result, reslen);
+	if (retval != ERROR_OK)
+		return retval;
+	/* Always output ctrl-d as end of line to allow multiline results */
+	return tcl_output(connection, "\x1a", 1);
+}
+
+/* Run one binary mode request, returns the size of the frame in @a used or
+ * 0 if it is not complete yet */
+static int tcl_run_frame(struct connection *connection, uint8_t *data,
+		size_t avail, size_t *used)
+{
+	Jim_Interp *interp = (Jim_Interp *)connection->cmd_ctx->interp;
+	struct target *target;
+	uint8_t *payload = data + TCL_FRAME_HEADER_SIZE;
+	uint8_t *buf;
+	char *line;
 	const char *result;
 	int reslen;
+	int retval;
+
+	*used = 0;
+	if (avail < TCL_FRAME_HEADER_SIZE)
+		return ERROR_OK;
+
+	uint32_t len = le_to_h_u32(data);
+	uint32_t id = le_to_h_u32(data + 4);
+	uint8_t type = data[8];
+
+	if (len > TCL_FRAME_MAX) {
+		LOG_ERROR("tcl: request of %" PRIu32 " bytes is too large", len);
+		return ERROR_SERVER_REMOTE_CLOSED;
+	}
+
+	if (avail < TCL_FRAME_HEADER_SIZE + len)
+		return ERROR_OK;
+	*used = TCL_FRAME_HEADER_SIZE + len;
+
+	switch (type) {
+	case TCL_FRAME_COMMAND:
+		line = malloc(len + 1);
+		if (line == NULL)
+			return tcl_output_frame(connection, type, id, ERROR_FAIL, NULL, 0);
+		memcpy(line, payload, len);
+		line[len] = '\0';
+
+		retval = command_run_line(connection->cmd_ctx, line);
+		free(line);
+		result = Jim_GetString(Jim_GetResult(interp), &reslen);
+		return tcl_output_frame(connection, type, id, retval, result, reslen);
+
+	case TCL_FRAME_READ_MEMORY:
+		/* u64 address, u32 byte count */
+		target = get_current_target_or_null(connection->cmd_ctx);
+		if (len != 12 || target == NULL)
+			return tcl_output_frame(connection, type, id, ERROR_FAIL, NULL, 0);
+
+		len = le_to_h_u32(payload + 8);
+		if (len > TCL_FRAME_MAX)
+			return tcl_output_frame(connection, type, id,
+					ERROR_COMMAND_ARGUMENT_INVALID, NULL, 0);
+
+		buf = malloc(len ? len : 1);
+		if (buf == NULL)
+			return tcl_output_frame(connection, type, id, ERROR_FAIL, NULL, 0);
+
+		retval = target_read_buffer(target, le_to_h_u64(payload), len, buf);
+		if (retval != ERROR_OK)
+			len = 0;
+		retval = tcl_output_frame(connection, type, id, retval, buf, len);
+		free(buf);
+		return retval;
+
+	case TCL_FRAME_WRITE_MEMORY:
+		/* u64 address, data */
+		target = get_current_target_or_null(connection->cmd_ctx);
+		if (len < 8 || target == NULL)
+			return tcl_output_frame(connection, type, id, ERROR_FAIL, NULL, 0);
+
+		retval = target_write_buffer(target, le_to_h_u64(payload), len - 8,
+				payload + 8);
+		return tcl_output_frame(connection, type, id, retval, NULL, 0);
+
+	default:
+		return tcl_output_frame(connection, type, id,
+				ERROR_COMMAND_SYNTAX_ERROR, NULL, 0);
+	}
+}
+
+static int tcl_input(struct connection *connection)
+{
+	int retval;
+	ssize_t rlen;
 	struct tcl_connection *tclc;
-	unsigned char in[256];
-	char *tc_line_new;
-	int tc_line_size_new;
+	char *line;
+	size_t done = 0;
+
+	tclc = connection->priv;
+	if (tclc == NULL)
+		return ERROR_CONNECTION_REJECTED;
+
+	if (tcl_line_reserve(tclc, TCL_READ_SIZE) != ERROR_OK) {
+		if (tclc->tc_binary) {
+			LOG_ERROR("tcl: out of memory");
+			return ERROR_SERVER_REMOTE_CLOSED;
+		}
+		/* maximum line size reached, drop line */
+		tclc->tc_linedrop = 1;
+		tclc->tc_lineoffset = 0;
+	}
 
-	rlen = connection_read(connection, &in, sizeof(in));
+	rlen = connection_read(connection, tclc->tc_line + tclc->tc_lineoffset,
+			TCL_READ_SIZE);
 	if (rlen <= 0) {
 		if (rlen < 0)
 			LOG_ERROR("error during read: %s", strerror(errno));
 		return ERROR_SERVER_REMOTE_CLOSED;
 	}
 
-	tclc = connection->priv;
-	if (tclc == NULL)
-		return ERROR_CONNECTION_REJECTED;
+	tclc->tc_lineoffset += rlen;
+	line = tclc->tc_line;
+
+	/* run everything that is complete, clients may send several
+	 * requests without waiting for the answers */
+	while (done < (size_t)tclc->tc_lineoffset) {
+		size_t avail = tclc->tc_lineoffset - done;
 
-	/* push as much data into the line as possible */
-	for (i = 0; i < rlen; i++) {
-		/* buffer the data */
-		tclc->tc_line[tclc->tc_lineoffset] = in[i];
-		if (tclc->tc_lineoffset < tclc->tc_line_size) {
-			tclc->tc_lineoffset++;
-		} else if (tclc->tc_line_size >= TCL_LINE_MAX) {
-			/* maximum line size reached, drop line */
-			tclc->tc_linedrop = 1;
-		} else {
-			/* grow line buffer: exponential below 1 MB, linear above */
-			if (tclc->tc_line_size <= 1*1024*1024)
-				tc_line_size_new = tclc->tc_line_size * 2;
-			else
-				tc_line_size_new = tclc->tc_line_size + 1*1024*1024;
-
-			if (tc_line_size_new > TCL_LINE_MAX)
-				tc_line_size_new = TCL_LINE_MAX;
-
-			tc_line_new = realloc(tclc->tc_line, tc_line_size_new);
-			if (tc_line_new == NULL) {
-				tclc->tc_linedrop = 1;
-			} else {
-				tclc->tc_line = tc_line_new;
-				tclc->tc_line_size = tc_line_size_new;
-				tclc->tc_lineoffset++;
-			}
+		if (tclc->tc_binary) {
+			size_t used;
 
+			retval = tcl_run_frame(connection, (uint8_t *)line + done, avail, &used);
+			if (retval != ERROR_OK)
+				return retval;
+			if (used == 0)
+				break;
+			done += used;
+			continue;
 		}
 
 		/* ctrl-z is end of command. When testing from telnet, just
 		 * press ctrl-z a couple of times first to put telnet into the
 		 * mode where it will send 0x1a in response to pressing ctrl-z
 		 */
-		if (in[i] != '\x1a')
-			continue;
-
-		/* process the line */
-		if (tclc->tc_linedrop) {
-#define ESTR "line too long\n"
-			retval = tcl_output(connection, ESTR, sizeof(ESTR));
-			if (retval != ERROR_OK)
-				return retval;
-#undef ESTR
-		} else {
-			tclc->tc_line[tclc->tc_lineoffset-1] = '\0';
-			command_run_line(connection->cmd_ctx, tclc->tc_line);
-			result = Jim_GetString(Jim_GetResult(interp), &reslen);
-			retval = tcl_output(connection, result, reslen);
-			if (retval != ERROR_OK)
-				return retval;
-			/* Always output ctrl-d as end of line to allow multiline results */
-			tcl_output(connection, "\x1a", 1);
-		}
+		char *end = memchr(line + done, '\x1a', avail);
+		if (end == NULL)
+			break;
+
+		*end = '\0';
+		retval = tcl_run_line(connection, line + done);
+		if (retval != ERROR_OK)
+			return retval;
+		done = end + 1 - line;
+	}
 
-		tclc->tc_lineoffset = 0;
-		tclc->tc_linedrop = 0;
+	if (!tclc->tc_binary && tclc->tc_linedrop) {
+		/* the rest belongs to the line being dropped */
+		done = tclc->tc_lineoffset;
 	}
 
+	tclc->tc_lineoffset -= done;
+	memmove(tclc->tc_line, tclc->tc_line + done, tclc->tc_lineoffset);
+
 	return ERROR_OK;
 }
 
@@ -310,6 +500,23 @@ COMMAND_HANDLER(handle_tcl_notifications_command)
 	}
 }
 
+COMMAND_HANDLER(handle_tcl_binary_command)
+{
+	struct connection *connection = NULL;
+	struct tcl_connection *tclc = NULL;
+
+	if (CMD_CTX->output_handler_priv != NULL)
+		connection = CMD_CTX->output_handler_priv;
+
+	if (connection != NULL && !strcmp(connection->service->name, "tcl")) {
+		tclc = connection->priv;
+		return CALL_COMMAND_HANDLER(handle_command_parse_bool, &tclc->tc_binary, "Binary framing ");
+	} else {
+		LOG_ERROR("%s: can only be called from the tcl server", CMD_NAME);
+		return ERROR_COMMAND_SYNTAX_ERROR;
+	}
+}
+
 COMMAND_HANDLER(handle_tcl_trace_command)
 {
 	struct connection *connection = NULL;
@@ -344,6 +551,13 @@ static const struct command_registration tcl_command_handlers[] = {
 		.help = "Target Notification output",
 		.usage = "[on|off]",
 	},
+	{
+		.name = "tcl_binary",
+		.handler = handle_tcl_binary_command,
+		.mode = COMMAND_EXEC,
+		.help = "Switch the current Tcl RPC connection to binary framing",
+		.usage = "[on|off]",
+	},
 	{
 		.name = "tcl_trace",
 		.handler = handle_tcl_trace_command,
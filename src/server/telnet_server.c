@@ -29,6 +29,7 @@
 #include "telnet_server.h"
 #include <target/target_request.h>
 #include <helper/configuration.h>
+#include <helper/time_support.h>
 
 static char *telnet_port;
 
@@ -41,21 +42,116 @@ static char *negotiate =
 #define CTRL(c) (c - '@')
 #define TELNET_HISTORY	".openocd_history"
 
-/* The only way we can detect that the socket is closed is the first time
+static bool telnet_would_block(void)
+{
+#ifdef _WIN32
+	return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+	return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+#endif
+}
+
+/* Hand as much queued output to the socket as it takes without blocking.
+ * Whatever is left is drained by server_loop() once the socket becomes
+ * writable again, so a slow telnet client does not hold up the GDB and
+ * Tcl servers.
+ *
+ * The only way we can detect that the socket is closed is the first time
  * we write to it, we will fail. Subsequent write operations will
  * succeed. Shudder!
  */
+static int telnet_flush(struct connection *connection)
+{
+	struct telnet_connection *t_con = connection->priv;
+
+	if (t_con->closed)
+		return ERROR_SERVER_REMOTE_CLOSED;
+
+	t_con->out_flush_time = timeval_ms();
+
+	while (t_con->out_start < t_con->out_end) {
+		int len = connection_write(connection, t_con->out_buf + t_con->out_start,
+				t_con->out_end - t_con->out_start);
+		if (len > 0) {
+			t_con->out_start += len;
+			continue;
+		}
+		if (len < 0 && telnet_would_block())
+			break;
+
+		t_con->closed = true;
+		connection->output_pending = 0;
+		return ERROR_SERVER_REMOTE_CLOSED;
+	}
+
+	if (t_con->out_start == t_con->out_end)
+		t_con->out_start = t_con->out_end = 0;
+	connection->output_pending = t_con->out_start < t_con->out_end;
+
+	return ERROR_OK;
+}
+
+/* Queue output; it reaches the socket in as few writes as possible, at the
+ * latest when the current input has been handled (see telnet_input()).
+ * No logging in here: this runs from telnet_log_callback().
+ */
 static int telnet_write(struct connection *connection, const void *data,
 	int len)
 {
 	struct telnet_connection *t_con = connection->priv;
+	size_t queued;
+	int retval;
+
 	if (t_con->closed)
 		return ERROR_SERVER_REMOTE_CLOSED;
+	if (len <= 0)
+		return ERROR_OK;
+
+	if (t_con->out_end + len > t_con->out_size && t_con->out_start) {
+		/* reclaim the space the socket has already taken */
+		memmove(t_con->out_buf, t_con->out_buf + t_con->out_start,
+			t_con->out_end - t_con->out_start);
+		t_con->out_end -= t_con->out_start;
+		t_con->out_start = 0;
+	}
 
-	if (connection_write(connection, data, len) == len)
+	if (t_con->out_end + len > t_con->out_size) {
+		size_t size = t_con->out_size ? t_con->out_size : TELNET_BUFFER_SIZE;
+		char *buf;
+
+		while (size < t_con->out_end + len)
+			size *= 2;
+		buf = realloc(t_con->out_buf, size);
+		if (!buf)
+			return ERROR_FAIL;
+		t_con->out_buf = buf;
+		t_con->out_size = size;
+	}
+
+	memcpy(t_con->out_buf + t_con->out_end, data, len);
+	t_con->out_end += len;
+
+	/* keep output of long running commands flowing */
+	queued = t_con->out_end - t_con->out_start;
+	if (queued < TELNET_OUTPUT_HIGH_WATERMARK &&
+			timeval_ms() - t_con->out_flush_time < TELNET_OUTPUT_FLUSH_MS)
 		return ERROR_OK;
-	t_con->closed = true;
-	return ERROR_SERVER_REMOTE_CLOSED;
+
+	retval = telnet_flush(connection);
+
+	/* the client does not keep up at all, wait for it rather than
+	 * queueing without bound */
+	while (retval == ERROR_OK &&
+			t_con->out_end - t_con->out_start >= TELNET_OUTPUT_MAX_SIZE) {
+		fd_set write_fds;
+
+		FD_ZERO(&write_fds);
+		FD_SET(connection->fd_out, &write_fds);
+		socket_select(connection->fd_out + 1, NULL, &write_fds, NULL, NULL);
+		retval = telnet_flush(connection);
+	}
+
+	return retval;
 }
 
 static int telnet_prompt(struct connection *connection)
@@ -132,6 +228,8 @@ static void telnet_log_callback(void *priv, const char *file, unsigned line,
 
 	for (i = t_con->line_cursor; i < t_con->line_size; i++)
 		telnet_write(connection, "\b", 1);
+
+	telnet_flush(connection);
 }
 
 static void telnet_load_history(struct telnet_connection *t_con)
@@ -232,6 +330,16 @@ static int telnet_new_connection(struct connection *connection)
 	telnet_connection->prompt = strdup("> ");
 	telnet_connection->prompt_visible = true;
 	telnet_connection->state = TELNET_STATE_DATA;
+	telnet_connection->out_buf = NULL;
+	telnet_connection->out_size = 0;
+	telnet_connection->out_start = 0;
+	telnet_connection->out_end = 0;
+	telnet_connection->out_flush_time = timeval_ms();
+
+	/* queued output is drained by server_loop() */
+	connection->output = telnet_flush;
+	if (connection->service->type == CONNECTION_TCP)
+		socket_nonblock(connection->fd);
 
 	/* output goes through telnet connection */
 	command_set_output_handler(connection->cmd_ctx, telnet_output, connection);
@@ -258,6 +366,8 @@ static int telnet_new_connection(struct connection *connection)
 
 	log_add_callback(telnet_log_callback, connection);
 
+	telnet_flush(connection);
+
 	return ERROR_OK;
 }
 
@@ -349,6 +459,9 @@ static int telnet_input(struct connection *connection)
 	if (bytes_read == 0)
 		return ERROR_SERVER_REMOTE_CLOSED;
 	else if (bytes_read == -1) {
+		/* the socket is non-blocking, select() may have woken us early */
+		if (telnet_would_block())
+			return ERROR_OK;
 		LOG_ERROR("error during read: %s", strerror(errno));
 		return ERROR_SERVER_REMOTE_CLOSED;
 	}
@@ -469,7 +582,10 @@ static int telnet_input(struct connection *connection)
 							/* the prompt is always * placed at the line beginning */
 							telnet_write(connection, "\r", 1);
 
-							retval = telnet_prompt(connection);
+							telnet_prompt(connection);
+
+							/* the command's output and the new prompt go out together */
+							retval = telnet_flush(connection);
 							if (retval == ERROR_SERVER_REMOTE_CLOSED)
 								return ERROR_SERVER_REMOTE_CLOSED;
 
@@ -617,7 +733,8 @@ static int telnet_input(struct connection *connection)
 		buf_p++;
 	}
 
-	return ERROR_OK;
+	/* echo and line editing of the whole chunk in one write */
+	return telnet_flush(connection);
 }
 
 static int telnet_connection_closed(struct connection *connection)
@@ -627,6 +744,11 @@ static int telnet_connection_closed(struct connection *connection)
 
 	log_remove_callback(telnet_log_callback, connection);
 
+	/* best effort, e.g. for the output of "exit" */
+	telnet_flush(connection);
+	free(t_con->out_buf);
+	t_con->out_buf = NULL;
+
 	if (t_con->prompt) {
 		free(t_con->prompt);
 		t_con->prompt = NULL;
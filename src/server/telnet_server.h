@@ -32,6 +32,13 @@
 #define TELNET_LINE_HISTORY_SIZE (128)
 #define TELNET_LINE_MAX_SIZE (10*256)
 
+/* queued output is pushed to the socket once it grows past this */
+#define TELNET_OUTPUT_HIGH_WATERMARK (64*1024)
+/* ... and the server waits for the client once it grows past this */
+#define TELNET_OUTPUT_MAX_SIZE (1024*1024)
+/* longest time output of a running command stays queued, in ms */
+#define TELNET_OUTPUT_FLUSH_MS (100)
+
 enum telnet_states {
 	TELNET_STATE_DATA,
 	TELNET_STATE_IAC,
@@ -56,6 +63,11 @@ struct telnet_connection {
 	size_t next_history;
 	size_t current_history;
 	bool closed;
+	char *out_buf;
+	size_t out_size;
+	size_t out_start;
+	size_t out_end;
+	int64_t out_flush_time;
 };
 
 struct telnet_service {
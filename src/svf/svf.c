@@ -593,7 +593,7 @@ free_all:
 
 static int svf_getline(char **lineptr, size_t *n, FILE *stream)
 {
-#define MIN_CHUNK 16	/* Buffer is increased by this size each time as required */
+#define MIN_CHUNK 16	/* Initial buffer size, doubled each time as required */
 	size_t i = 0;
 
 	if (*lineptr == NULL) {
@@ -603,22 +603,31 @@ static int svf_getline(char **lineptr, size_t *n, FILE *stream)
 			return -1;
 	}
 
-	(*lineptr)[0] = fgetc(stream);
-	while ((*lineptr)[i] != '\n') {
-		(*lineptr)[++i] = fgetc(stream);
+	for (;;) {
+		if (!fgets(*lineptr + i, *n - i, stream)) {
+			(*lineptr)[0] = 0;
+			return -1;
+		}
+		i += strlen(*lineptr + i);
+		if (i > 0 && (*lineptr)[i - 1] == '\n')
+			break;
 		if (feof(stream)) {
+			/* an unterminated last line is dropped, like before */
 			(*lineptr)[0] = 0;
 			return -1;
 		}
-		if ((i + 2) > *n) {
-			*n += MIN_CHUNK;
-			*lineptr = realloc(*lineptr, *n);
+
+		/* SVF writers may put a whole long vector on one line */
+		char *ptr = realloc(*lineptr, *n * 2);
+		if (!ptr) {
+			(*lineptr)[0] = 0;
+			return -1;
 		}
+		*lineptr = ptr;
+		*n *= 2;
 	}
 
-	(*lineptr)[++i] = 0;
-
-	return sizeof(*lineptr);
+	return i;
 }
 
 #define SVFP_CMD_INC_CNT 1024
@@ -682,8 +691,9 @@ static int svf_read_command_from_file(FILE *fd)
 				 *  - terminating NUL ('\0')
 				 */
 				if (cmd_pos + 3 > svf_command_buffer_size) {
-					svf_command_buffer = realloc(svf_command_buffer, cmd_pos + 3);
-					svf_command_buffer_size = cmd_pos + 3;
+					size_t new_size = MAX(cmd_pos + 3, 2 * svf_command_buffer_size);
+					svf_command_buffer = realloc(svf_command_buffer, new_size);
+					svf_command_buffer_size = new_size;
 					if (svf_command_buffer == NULL) {
 						LOG_ERROR("not enough memory");
 						return ERROR_FAIL;
@@ -566,6 +566,8 @@ static int aarch64_restore_one(struct target *target, int current,
 
 	LOG_DEBUG("%s", target_name(target));
 
+	arm_tlb_flush(arm);
+
 	if (!debug_execution)
 		target_free_all_working_areas(target);
 
@@ -1053,6 +1055,9 @@ static int aarch64_post_debug_entry(struct target *target)
 	LOG_DEBUG("System_register: %8.8" PRIx32, aarch64->system_control_reg);
 	aarch64->system_control_reg_curr = aarch64->system_control_reg;
 
+	/* translations are only trusted until the core runs again */
+	arm_tlb_flush(&armv8->arm);
+
 	if (armv8->armv8_mmu.armv8_cache.info == -1) {
 		armv8_identify_cache(armv8);
 		armv8_read_mpidr(armv8);
@@ -2150,6 +2155,9 @@ static int aarch64_write_phys_memory(struct target *target,
 	int retval = ERROR_COMMAND_SYNTAX_ERROR;
 
 	if (count && buffer) {
+		/* the write may change the translation tables */
+		arm_tlb_flush(target_to_arm(target));
+
 		/* write memory through APB-AP */
 		retval = aarch64_mmu_modify(target, 0);
 		if (retval != ERROR_OK)
@@ -2177,6 +2185,10 @@ static int aarch64_write_memory(struct target *target, target_addr_t address,
 		if (retval != ERROR_OK)
 			return retval;
 	}
+
+	/* the write may change the translation tables */
+	arm_tlb_flush(target_to_arm(target));
+
 	return aarch64_write_cpu_memory(target, address, size, count, buffer);
 }
 
@@ -2385,7 +2397,7 @@ static int aarch64_init_arch_info(struct target *target,
 	armv8->armv8_mmu.read_physical_memory = aarch64_read_phys_memory;
 
 	armv8_init_arch_info(target, armv8);
-	target_register_timer_callback(aarch64_handle_target_request, 1, 1, target);
+	target_register_adaptive_timer_callback(aarch64_handle_target_request, 0, target);
 
 	return ERROR_OK;
 }
@@ -2429,7 +2441,15 @@ static int aarch64_mmu(struct target *target, int *enabled)
 static int aarch64_virt2phys(struct target *target, target_addr_t virt,
 			     target_addr_t *phys)
 {
-	return armv8_mmu_translate_va_pa(target, virt, phys, 1);
+	if (arm_tlb_lookup(target_to_arm(target), virt, phys))
+		return ERROR_OK;
+
+	int retval = armv8_mmu_translate_va_pa(target, virt, phys, 1);
+	if (retval != ERROR_OK)
+		return retval;
+
+	arm_tlb_insert(target_to_arm(target), virt, *phys);
+	return ERROR_OK;
 }
 
 /*
@@ -2727,6 +2747,10 @@ static int jim_mcrmrc(Jim_Interp *interp, int argc, Jim_Obj * const *argv)
 		/* NOTE: parameters reordered! */
 		/* ARMV4_5_MCR(cpnum, op1, 0, CRn, CRm, op2) */
 		retval = arm->mcr(target, cpnum, op1, op2, CRn, CRm, value);
+
+		/* may have changed TTBRx, TTBCR, SCTLR, ... */
+		arm_tlb_flush(arm);
+
 		if (retval != ERROR_OK)
 			return JIM_ERR;
 	} else {
@@ -38,6 +38,7 @@
 #include "arm_adi_v5.h"
 #include <helper/time_support.h>
 #include <helper/list.h>
+#include <helper/perf.h>
 
 /*#define DEBUG_WAIT*/
 
@@ -370,6 +371,8 @@ static int jtagdp_overrun_check(struct adiv5_dap *dap)
 		if (el->ack == JTAG_ACK_OK_FAULT) {
 			log_dap_cmd("LOG", el);
 		} else if (el->ack == JTAG_ACK_WAIT) {
+			static struct perf_stat dap_wait_stat = PERF_STAT_INIT("dap.wait");
+			perf_count(&dap_wait_stat, 1);
 			found_wait = 1;
 			break;
 		} else {
@@ -138,6 +138,17 @@ enum arm_vfp_version {
 
 #define ARM_COMMON_MAGIC 0x0A450A45
 
+/** Number of page translations remembered while the core is halted. */
+#define ARM_TLB_SIZE 64
+#define ARM_TLB_PAGE_SIZE 4096
+
+/** A virtual to physical page translation. */
+struct arm_tlb_entry {
+	target_addr_t va;
+	target_addr_t pa;
+	bool valid;
+};
+
 /**
  * Represents a generic ARM core, with standard application registers.
  *
@@ -227,6 +238,12 @@ struct arm {
 	 * used to make requests to the target.
 	 */
 	struct adiv5_dap *dap;
+
+	/**
+	 * Translations done by virt2phys since the core halted. Cores with
+	 * an MMU flush this whenever the core runs, or memory is written.
+	 */
+	struct arm_tlb_entry tlb[ARM_TLB_SIZE];
 };
 
 /** Convert target handle to generic ARM target state handle. */
@@ -294,6 +311,10 @@ int arm_blank_check_memory(struct target *target,
 		struct target_memory_check_block *blocks, int num_blocks, uint8_t erased_value);
 
 void arm_set_cpsr(struct arm *arm, uint32_t cpsr);
+
+void arm_tlb_flush(struct arm *arm);
+bool arm_tlb_lookup(struct arm *arm, target_addr_t va, target_addr_t *pa);
+void arm_tlb_insert(struct arm *arm, target_addr_t va, target_addr_t pa);
 struct reg *arm_reg_current(struct arm *arm, unsigned regnum);
 struct reg *armv8_reg_current(struct arm *arm, unsigned regnum);
 
@@ -2858,8 +2858,8 @@ int arm7_9_init_arch_info(struct target *target, struct arm7_9_common *arm7_9)
 	if (retval != ERROR_OK)
 		return retval;
 
-	return target_register_timer_callback(arm7_9_handle_target_request,
-		1, 1, target);
+	return target_register_adaptive_timer_callback(arm7_9_handle_target_request,
+		0, target);
 }
 
 static const struct command_registration arm7_9_any_command_handlers[] = {
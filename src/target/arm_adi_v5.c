@@ -78,6 +78,9 @@
 #include <helper/list.h>
 #include <helper/jim-nvp.h>
 
+/* time spent in dap_run(), i.e. waiting for queued DAP transactions */
+struct perf_stat dap_run_stat = PERF_STAT_INIT("dap.run");
+
 /* ARM ADI Specification requires at least 10 bits used for TAR autoincrement  */
 
 /*
@@ -30,6 +30,7 @@
  */
 
 #include <helper/list.h>
+#include <helper/perf.h>
 #include "arm_jtag.h"
 
 /* three-bit ACK values for SWD access (sent LSB first) */
@@ -399,6 +400,9 @@ static inline int dap_queue_ap_abort(struct adiv5_dap *dap, uint8_t *ack)
 	return dap->ops->queue_ap_abort(dap, ack);
 }
 
+/* time spent in dap_run(), see the "perf" command */
+extern struct perf_stat dap_run_stat;
+
 /**
  * Perform all queued DAP operations, and clear any errors posted in the
  * CTRL_STAT register when they are done.  Note that if more than one AP
@@ -412,7 +416,12 @@ static inline int dap_queue_ap_abort(struct adiv5_dap *dap, uint8_t *ack)
 static inline int dap_run(struct adiv5_dap *dap)
 {
 	assert(dap->ops != NULL);
-	return dap->ops->run(dap);
+
+	int64_t start = perf_start();
+	int retval = dap->ops->run(dap);
+	perf_end(&dap_run_stat, start, 0, 0, retval);
+
+	return retval;
 }
 
 static inline int dap_sync(struct adiv5_dap *dap)
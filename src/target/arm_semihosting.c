@@ -312,7 +312,7 @@ int arm_semihosting(struct target *target, int *retval)
 		}
 
 		/* Check for ARM operation numbers. */
-		if (0 <= semihosting->op && semihosting->op <= 0x31) {
+		if (semihosting_is_operation(semihosting->op)) {
 			*retval = semihosting_common(target);
 			if (*retval != ERROR_OK) {
 				LOG_ERROR("Failed semihosting operation");
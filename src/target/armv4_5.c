@@ -1083,6 +1083,10 @@ static int jim_mcrmrc(Jim_Interp *interp, int argc, Jim_Obj * const *argv)
 		/* NOTE: parameters reordered! */
 		/* ARMV4_5_MCR(cpnum, op1, 0, CRn, CRm, op2) */
 		retval = arm->mcr(target, cpnum, op1, op2, CRn, CRm, value);
+
+		/* may have changed TTBRx, TTBCR, SCTLR, ... */
+		arm_tlb_flush(arm);
+
 		if (retval != ERROR_OK)
 			return JIM_ERR;
 	} else {
@@ -1687,12 +1691,47 @@ static int arm_default_mcr(struct target *target, int cpnum,
 	return ERROR_FAIL;
 }
 
+void arm_tlb_flush(struct arm *arm)
+{
+	for (int i = 0; i < ARM_TLB_SIZE; i++)
+		arm->tlb[i].valid = false;
+}
+
+static struct arm_tlb_entry *arm_tlb_entry(struct arm *arm, target_addr_t va)
+{
+	return &arm->tlb[(va / ARM_TLB_PAGE_SIZE) % ARM_TLB_SIZE];
+}
+
+/** Look up the physical address of @a va among the cached translations. */
+bool arm_tlb_lookup(struct arm *arm, target_addr_t va, target_addr_t *pa)
+{
+	target_addr_t page = va & ~(target_addr_t)(ARM_TLB_PAGE_SIZE - 1);
+	struct arm_tlb_entry *entry = arm_tlb_entry(arm, va);
+
+	if (!entry->valid || entry->va != page)
+		return false;
+
+	*pa = entry->pa | (va & (ARM_TLB_PAGE_SIZE - 1));
+	return true;
+}
+
+/** Remember that @a va translates to @a pa, valid for the whole page. */
+void arm_tlb_insert(struct arm *arm, target_addr_t va, target_addr_t pa)
+{
+	struct arm_tlb_entry *entry = arm_tlb_entry(arm, va);
+
+	entry->va = va & ~(target_addr_t)(ARM_TLB_PAGE_SIZE - 1);
+	entry->pa = pa & ~(target_addr_t)(ARM_TLB_PAGE_SIZE - 1);
+	entry->valid = true;
+}
+
 int arm_init_arch_info(struct target *target, struct arm *arm)
 {
 	target->arch_info = arm;
 	arm->target = target;
 
 	arm->common_magic = ARM_COMMON_MAGIC;
+	arm_tlb_flush(arm);
 
 	/* core_type may be overridden by subtype logic */
 	if (arm->core_type != ARM_MODE_THREAD) {
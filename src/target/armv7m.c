@@ -379,7 +379,8 @@ int armv7m_start_algorithm(struct target *target,
 	}
 
 	for (int i = 0; i < num_mem_params; i++) {
-		/* TODO: Write only out params */
+		if (mem_params[i].direction == PARAM_IN)
+			continue;
 		retval = target_write_buffer(target, mem_params[i].address,
 				mem_params[i].size,
 				mem_params[i].value);
@@ -403,7 +404,11 @@ int armv7m_start_algorithm(struct target *target,
 			return ERROR_COMMAND_SYNTAX_ERROR;
 		}
 
-/*		regvalue = buf_get_u32(reg_params[i].value, 0, 32); */
+		/* only registers that change have to be written on resume */
+		if (reg->valid && buf_get_u32(reg->value, 0, 32) ==
+				buf_get_u32(reg_params[i].value, 0, 32))
+			continue;
+
 		armv7m_set_core_reg(reg, reg_params[i].value);
 	}
 
@@ -419,9 +424,11 @@ int armv7m_start_algorithm(struct target *target,
 		 * it might be 0 if the vector table has "bad" data in it.
 		 */
 		struct reg *reg = &armv7m->arm.core_cache->reg_list[ARMV7M_xPSR];
-		buf_set_u32(reg->value, 0, 32, 0x01000000);
-		reg->valid = 1;
-		reg->dirty = 1;
+		if (!reg->valid || buf_get_u32(reg->value, 0, 32) != 0x01000000) {
+			buf_set_u32(reg->value, 0, 32, 0x01000000);
+			reg->valid = 1;
+			reg->dirty = 1;
+		}
 	}
 
 	if (armv7m_algorithm_info->core_mode != ARM_MODE_ANY &&
@@ -480,7 +487,11 @@ int armv7m_wait_algorithm(struct target *target,
 		return ERROR_TARGET_TIMEOUT;
 	}
 
-	armv7m->load_core_reg_u32(target, 15, &pc);
+	/* the core registers were just read back on debug entry */
+	if (armv7m->arm.pc->valid)
+		pc = buf_get_u32(armv7m->arm.pc->value, 0, 32);
+	else
+		armv7m->load_core_reg_u32(target, 15, &pc);
 	if (exit_point && (pc != exit_point)) {
 		LOG_DEBUG("failed algorithm halted at 0x%" PRIx32 ", expected 0x%" TARGET_PRIxADDR,
 			pc,
@@ -38,6 +38,8 @@ static int armv7m_poll_trace(void *target)
 	if (retval != ERROR_OK || !size)
 		return retval;
 
+	target_timer_callback_active();
+
 	target_call_trace_callbacks(target, size, buf);
 
 	if (armv7m->trace_config.trace_file != NULL) {
@@ -116,7 +118,7 @@ int armv7m_trace_tpiu_config(struct target *target)
 		return retval;
 
 	if (trace_config->config_type == TRACE_CONFIG_TYPE_INTERNAL)
-		target_register_timer_callback(armv7m_poll_trace, 1, 1, target);
+		target_register_adaptive_timer_callback(armv7m_poll_trace, 0, target);
 
 	target_call_event_callbacks(target, TARGET_EVENT_TRACE_CONFIG);
 
@@ -807,6 +807,8 @@ static int cortex_a_internal_restore(struct target *target, int current,
 	int retval;
 	uint32_t resume_pc;
 
+	arm_tlb_flush(arm);
+
 	if (!debug_execution)
 		target_free_all_working_areas(target);
 
@@ -1108,6 +1110,9 @@ static int cortex_a_post_debug_entry(struct target *target)
 	if (!armv7a->is_armv7r)
 		armv7a_read_ttbcr(target);
 
+	/* translations are only trusted until the core runs again */
+	arm_tlb_flush(&armv7a->arm);
+
 	if (armv7a->armv7a_mmu.armv7a_cache.info == -1)
 		armv7a_identify_cache(target);
 
@@ -2513,6 +2518,9 @@ static int cortex_a_write_phys_memory(struct target *target,
 	LOG_DEBUG("Writing memory to real address " TARGET_ADDR_FMT "; size %" PRId32 "; count %" PRId32,
 		address, size, count);
 
+	/* the write may change the translation tables */
+	arm_tlb_flush(target_to_arm(target));
+
 	/* write memory through the CPU */
 	cortex_a_prep_memaccess(target, 1);
 	retval = cortex_a_write_cpu_memory(target, address, size, count, buffer);
@@ -2533,6 +2541,9 @@ static int cortex_a_write_memory(struct target *target, target_addr_t address,
 	/* memory writes bypass the caches, must flush before writing */
 	armv7a_cache_auto_flush_on_write(target, address, size * count);
 
+	/* the write may change the translation tables */
+	arm_tlb_flush(target_to_arm(target));
+
 	cortex_a_prep_memaccess(target, 0);
 	retval = cortex_a_write_cpu_memory(target, address, size, count, buffer);
 	cortex_a_post_memaccess(target, 0);
@@ -2846,7 +2857,7 @@ static int cortex_a_init_arch_info(struct target *target,
 
 	/* REVISIT v7a setup should be in a v7a-specific routine */
 	armv7a_init_arch_info(target, armv7a);
-	target_register_timer_callback(cortex_a_handle_target_request, 1, 1, target);
+	target_register_adaptive_timer_callback(cortex_a_handle_target_request, 0, target);
 
 	return ERROR_OK;
 }
@@ -2944,12 +2955,22 @@ static int cortex_a_virt2phys(struct target *target,
 		return ERROR_OK;
 	}
 
+	if (arm_tlb_lookup(target_to_arm(target), virt, phys))
+		return ERROR_OK;
+
 	/* mmu must be enable in order to get a correct translation */
 	retval = cortex_a_mmu_modify(target, 1);
 	if (retval != ERROR_OK)
 		return retval;
-	return armv7a_mmu_translate_va_pa(target, (uint32_t)virt,
-						    (uint32_t *)phys, 1);
+
+	uint32_t pa;
+	retval = armv7a_mmu_translate_va_pa(target, (uint32_t)virt, &pa, 1);
+	if (retval != ERROR_OK)
+		return retval;
+
+	*phys = pa;
+	arm_tlb_insert(target_to_arm(target), virt, pa);
+	return ERROR_OK;
 }
 
 COMMAND_HANDLER(cortex_a_handle_cache_info_command)
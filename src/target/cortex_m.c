@@ -122,6 +122,214 @@ static int cortexm_dap_write_coreregister_u32(struct target *target,
 	return retval;
 }
 
+/* DCRSR selector holding PRIMASK, BASEPRI, FAULTMASK and CONTROL */
+#define CORTEX_M_SPECIAL_REGSEL	20
+
+/* Merge the dirty special registers into the current DCRSR selector 20
+ * word; everything else, e.g. CONTROL.FPCA and SFPA, is kept as is */
+static void cortex_m_merge_special_regs(struct reg_cache *cache, uint32_t *value)
+{
+	struct reg *r = cache->reg_list;
+
+	if (r[ARMV7M_PRIMASK].dirty)
+		buf_set_u32((uint8_t *)value, 0, 1, buf_get_u32(r[ARMV7M_PRIMASK].value, 0, 1));
+	if (r[ARMV7M_BASEPRI].dirty)
+		buf_set_u32((uint8_t *)value, 8, 8, buf_get_u32(r[ARMV7M_BASEPRI].value, 0, 8));
+	if (r[ARMV7M_FAULTMASK].dirty)
+		buf_set_u32((uint8_t *)value, 16, 1, buf_get_u32(r[ARMV7M_FAULTMASK].value, 0, 1));
+	if (r[ARMV7M_CONTROL].dirty)
+		buf_set_u32((uint8_t *)value, 24, 2, buf_get_u32(r[ARMV7M_CONTROL].value, 0, 2));
+}
+
+/* Transfers queued back to back are only valid if the core completed each
+ * one before the next DCRDR access, which DHCSR.S_REGRDY tells */
+static bool cortex_m_regrdy_all(const uint32_t *dhcsr, int count)
+{
+	for (int i = 0; i < count; i++) {
+		if (!(dhcsr[i] & S_REGRDY)) {
+			LOG_DEBUG("core register transfer not ready, using slow path");
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/**
+ * Read R0..PSP and the special registers with a single DAP run instead
+ * of one round trip per register. Registers that are already valid are
+ * left alone; on failure nothing is marked valid and the caller falls
+ * back to reading registers one by one.
+ */
+static int cortex_m_fast_read_core_regs(struct target *target)
+{
+	struct armv7m_common *armv7m = target_to_armv7m(target);
+	struct reg_cache *cache = armv7m->arm.core_cache;
+	uint32_t values[ARMV7M_PSP + 1];
+	uint32_t dhcsr[ARMV7M_PSP + 2];
+	uint32_t special;
+	int retval;
+
+	/* the emulated DCC channel needs DCRDR preserved around each access */
+	if (target->dbg_msg_enabled)
+		return ERROR_FAIL;
+
+	for (int i = 0; i <= ARMV7M_PSP; i++) {
+		retval = mem_ap_write_u32(armv7m->debug_ap, DCB_DCRSR, i);
+		if (retval != ERROR_OK)
+			return retval;
+		retval = mem_ap_read_u32(armv7m->debug_ap, DCB_DHCSR, &dhcsr[i]);
+		if (retval != ERROR_OK)
+			return retval;
+		retval = mem_ap_read_u32(armv7m->debug_ap, DCB_DCRDR, &values[i]);
+		if (retval != ERROR_OK)
+			return retval;
+	}
+
+	retval = mem_ap_write_u32(armv7m->debug_ap, DCB_DCRSR, CORTEX_M_SPECIAL_REGSEL);
+	if (retval != ERROR_OK)
+		return retval;
+	retval = mem_ap_read_u32(armv7m->debug_ap, DCB_DHCSR, &dhcsr[ARMV7M_PSP + 1]);
+	if (retval != ERROR_OK)
+		return retval;
+	retval = mem_ap_read_u32(armv7m->debug_ap, DCB_DCRDR, &special);
+	if (retval != ERROR_OK)
+		return retval;
+
+	retval = dap_run(armv7m->arm.dap);
+	if (retval != ERROR_OK)
+		return retval;
+
+	if (!cortex_m_regrdy_all(dhcsr, ARRAY_SIZE(dhcsr)))
+		return ERROR_FAIL;
+
+	for (int i = 0; i <= ARMV7M_CONTROL; i++) {
+		struct reg *r = &cache->reg_list[i];
+		uint32_t value;
+
+		if (r->valid)
+			continue;
+
+		switch (i) {
+			case ARMV7M_PRIMASK:
+				value = buf_get_u32((uint8_t *)&special, 0, 1);
+				break;
+			case ARMV7M_BASEPRI:
+				value = buf_get_u32((uint8_t *)&special, 8, 8);
+				break;
+			case ARMV7M_FAULTMASK:
+				value = buf_get_u32((uint8_t *)&special, 16, 1);
+				break;
+			case ARMV7M_CONTROL:
+				value = buf_get_u32((uint8_t *)&special, 24, 2);
+				break;
+			default:
+				value = values[i];
+				break;
+		}
+
+		buf_set_u32(r->value, 0, 32, value);
+		r->valid = 1;
+		r->dirty = 0;
+	}
+
+	return ERROR_OK;
+}
+
+/**
+ * Write back the dirty registers among R0..PSP and the special registers
+ * with a single DAP run, in the same order armv7m_restore_context() uses.
+ * Dirty special registers cost one extra read of selector 20 first.
+ * Returns ERROR_FAIL when the batch cannot be used or the core was not
+ * ready for every transfer, in which case the generic restore writes the
+ * registers, still dirty, one by one.
+ */
+static int cortex_m_fast_write_core_regs(struct target *target)
+{
+	struct armv7m_common *armv7m = target_to_armv7m(target);
+	struct reg_cache *cache = armv7m->arm.core_cache;
+	uint32_t dhcsr[ARMV7M_PSP + 2];
+	int count = 0;
+	bool special_dirty = false;
+	int retval;
+
+	if (target->dbg_msg_enabled)
+		return ERROR_FAIL;
+
+	/* keep the ordering with the FPU registers restored before these */
+	for (unsigned i = ARMV7M_CONTROL + 1; i < cache->num_regs; i++) {
+		if (cache->reg_list[i].dirty)
+			return ERROR_FAIL;
+	}
+
+	for (int i = ARMV7M_PRIMASK; i <= ARMV7M_CONTROL; i++) {
+		if (cache->reg_list[i].dirty)
+			special_dirty = true;
+		else if (!cache->reg_list[i].valid)
+			return ERROR_FAIL;
+	}
+
+	if (special_dirty) {
+		uint32_t special;
+
+		/* selector 20 also holds fields we don't cache, so it has to be
+		 * read back before the batch can write it */
+		retval = cortexm_dap_read_coreregister_u32(target, &special,
+				CORTEX_M_SPECIAL_REGSEL);
+		if (retval != ERROR_OK)
+			return retval;
+		cortex_m_merge_special_regs(cache, &special);
+
+		retval = mem_ap_write_u32(armv7m->debug_ap, DCB_DCRDR, special);
+		if (retval != ERROR_OK)
+			return retval;
+		retval = mem_ap_write_u32(armv7m->debug_ap, DCB_DCRSR,
+				CORTEX_M_SPECIAL_REGSEL | DCRSR_WnR);
+		if (retval != ERROR_OK)
+			return retval;
+		retval = mem_ap_read_u32(armv7m->debug_ap, DCB_DHCSR, &dhcsr[count++]);
+		if (retval != ERROR_OK)
+			return retval;
+	}
+
+	for (int i = ARMV7M_PSP; i >= 0; i--) {
+		struct reg *r = &cache->reg_list[i];
+
+		if (!r->dirty)
+			continue;
+
+		retval = mem_ap_write_u32(armv7m->debug_ap, DCB_DCRDR, buf_get_u32(r->value, 0, 32));
+		if (retval != ERROR_OK)
+			return retval;
+		retval = mem_ap_write_u32(armv7m->debug_ap, DCB_DCRSR, i | DCRSR_WnR);
+		if (retval != ERROR_OK)
+			return retval;
+		retval = mem_ap_read_u32(armv7m->debug_ap, DCB_DHCSR, &dhcsr[count++]);
+		if (retval != ERROR_OK)
+			return retval;
+	}
+
+	retval = dap_run(armv7m->arm.dap);
+	if (retval != ERROR_OK) {
+		LOG_ERROR("JTAG failure");
+		return ERROR_JTAG_DEVICE_ERROR;
+	}
+
+	/* the registers stay dirty, so the slow path writes all of them again */
+	if (!cortex_m_regrdy_all(dhcsr, count))
+		return ERROR_FAIL;
+
+	for (int i = 0; i <= ARMV7M_CONTROL; i++) {
+		if (cache->reg_list[i].dirty) {
+			LOG_DEBUG("write core reg %s value 0x%" PRIx32, cache->reg_list[i].name,
+					buf_get_u32(cache->reg_list[i].value, 0, 32));
+			cache->reg_list[i].dirty = 0;
+		}
+	}
+
+	return ERROR_OK;
+}
+
 static int cortex_m_write_debug_halt_mask(struct target *target,
 	uint32_t mask_on, uint32_t mask_off)
 {
@@ -418,6 +626,9 @@ static int cortex_m_debug_entry(struct target *target)
 	 * First load register accessible through core debug port */
 	int num_regs = arm->core_cache->num_regs;
 
+	if (cortex_m_fast_read_core_regs(target) != ERROR_OK)
+		LOG_DEBUG("batched register read failed, reading registers one by one");
+
 	for (i = 0; i < num_regs; i++) {
 		r = &armv7m->arm.core_cache->reg_list[i];
 		if (!r->valid)
@@ -736,6 +947,8 @@ static int cortex_m_resume(struct target *target, int current,
 
 	resume_pc = buf_get_u32(r->value, 0, 32);
 
+	/* anything the batch did not write is restored one by one */
+	cortex_m_fast_write_core_regs(target);
 	armv7m_restore_context(target);
 
 	/* the front-end may request us not to handle breakpoints */
@@ -2248,7 +2461,7 @@ static int cortex_m_init_arch_info(struct target *target,
 	armv7m->load_core_reg_u32 = cortex_m_load_core_reg_u32;
 	armv7m->store_core_reg_u32 = cortex_m_store_core_reg_u32;
 
-	target_register_timer_callback(cortex_m_handle_target_request, 1, 1, target);
+	target_register_adaptive_timer_callback(cortex_m_handle_target_request, 0, target);
 
 	return ERROR_OK;
 }
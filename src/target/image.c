@@ -115,8 +115,79 @@ static int identify_image_type(struct image *image, const char *type_string, con
 	return ERROR_OK;
 }
 
+/* value of each hex digit character, 0xff for anything else */
+static const uint8_t *image_hex_table(void)
+{
+	static uint8_t table[256];
+	static bool first_init;
+
+	if (!first_init) {
+		memset(table, 0xff, sizeof(table));
+		for (unsigned int i = 0; i < 10; i++)
+			table['0' + i] = i;
+		for (unsigned int i = 0; i < 6; i++) {
+			table['a' + i] = 10 + i;
+			table['A' + i] = 10 + i;
+		}
+
+		first_init = true;
+	}
+
+	return table;
+}
+
+/* Decode @a count bytes given as pairs of hex digits, fails on anything else */
+static bool image_decode_hex(const char *hex, size_t count, uint8_t *out)
+{
+	const uint8_t *table = image_hex_table();
+	uint8_t invalid = 0;
+
+	for (size_t i = 0; i < count; i++) {
+		uint8_t hi = table[(uint8_t)hex[2 * i]];
+		uint8_t lo = table[(uint8_t)hex[2 * i + 1]];
+
+		invalid |= hi | lo;
+		out[i] = (hi << 4) | lo;
+	}
+
+	return !(invalid & 0xf0);
+}
+
+/* Split the next line off a text image held in memory, without its terminator */
+static bool image_next_line(const char **pos, const char *end,
+	const char **line, size_t *len)
+{
+	const char *eol;
+
+	if (*pos >= end)
+		return false;
+
+	eol = memchr(*pos, '\n', end - *pos);
+	if (eol == NULL)
+		eol = end;
+
+	*line = *pos;
+	*len = eol - *pos;
+	*pos = (eol < end) ? eol + 1 : end;
+
+	return true;
+}
+
+/* Comments and blank lines are skipped in text images */
+static bool image_line_is_blank(const char *line, size_t len)
+{
+	if (len > 0 && line[0] == '#')
+		return true;
+
+	for (size_t i = 0; i < len; i++) {
+		if (line[i] != ' ' && line[i] != '\t' && line[i] != '\r')
+			return false;
+	}
+
+	return true;
+}
+
 static int image_ihex_buffer_complete_inner(struct image *image,
-	char *lpszLine,
 	struct imagesection *section)
 {
 	struct image_ihex *ihex = image->type_private;
@@ -124,49 +195,68 @@ static int image_ihex_buffer_complete_inner(struct image *image,
 	uint32_t full_address;
 	uint32_t cooked_bytes;
 	bool end_rec = false;
+	const char *pos, *end, *line;
+	size_t len;
 	int i;
 
 	/* we can't determine the number of sections that we'll have to create ahead of time,
 	 * so we locally hold them until parsing is finished */
 
 	size_t filesize;
+	uint8_t *content;
 	int retval;
 	retval = fileio_size(fileio, &filesize);
 	if (retval != ERROR_OK)
 		return retval;
 
+	/* parse the whole file from memory rather than line by line through stdio */
+	retval = fileio_map(fileio, &content);
+	if (retval != ERROR_OK)
+		return retval;
+	pos = (const char *)content;
+	end = pos + filesize;
+
 	ihex->buffer = malloc(filesize >> 1);
 	cooked_bytes = 0x0;
 	image->num_sections = 0;
 
-	while (!fileio_feof(fileio)) {
+	while (pos < end) {
 		full_address = 0x0;
 		section[image->num_sections].private = &ihex->buffer[cooked_bytes];
 		section[image->num_sections].base_address = 0x0;
 		section[image->num_sections].size = 0x0;
 		section[image->num_sections].flags = 0;
 
-		while (fileio_fgets(fileio, 1023, lpszLine) == ERROR_OK) {
+		while (image_next_line(&pos, end, &line, &len)) {
+			/* byte count, address, record type, data and checksum */
+			uint8_t record[5 + 255];
+			uint8_t *data = &record[4];
 			uint32_t count;
 			uint32_t address;
 			uint32_t record_type;
-			uint32_t checksum;
 			uint8_t cal_checksum = 0;
-			size_t bytes_read = 0;
 
 			/* skip comments and blank lines */
-			if ((lpszLine[0] == '#') || (strlen(lpszLine + strspn(lpszLine, "\n\t\r ")) == 0))
+			if (image_line_is_blank(line, len))
 				continue;
 
-			if (sscanf(&lpszLine[bytes_read], ":%2" SCNx32 "%4" SCNx32 "%2" SCNx32, &count,
-				&address, &record_type) != 3)
+			if (len < 11 || line[0] != ':' || !image_decode_hex(line + 1, 1, record))
 				return ERROR_IMAGE_FORMAT_ERROR;
-			bytes_read += 9;
+			count = record[0];
+			if (len < 1 + 2 * (5 + count) || !image_decode_hex(line + 1, 5 + count, record))
+				return ERROR_IMAGE_FORMAT_ERROR;
+
+			address = (record[1] << 8) | record[2];
+			record_type = record[3];
 
-			cal_checksum += (uint8_t)count;
-			cal_checksum += (uint8_t)(address >> 8);
-			cal_checksum += (uint8_t)address;
-			cal_checksum += (uint8_t)record_type;
+			for (uint32_t j = 0; j < 5 + count; j++)
+				cal_checksum += record[j];
+
+			if (cal_checksum != 0) {
+				/* checksum failed */
+				LOG_ERROR("incorrect record checksum found in IHEX file");
+				return ERROR_IMAGE_CHECKSUM;
+			}
 
 			if (record_type == 0) {	/* Data Record */
 				if ((full_address & 0xffff) != address) {
@@ -191,16 +281,10 @@ static int image_ihex_buffer_complete_inner(struct image *image,
 					full_address = (full_address & 0xffff0000) | address;
 				}
 
-				while (count-- > 0) {
-					unsigned value;
-					sscanf(&lpszLine[bytes_read], "%2x", &value);
-					ihex->buffer[cooked_bytes] = (uint8_t)value;
-					cal_checksum += (uint8_t)ihex->buffer[cooked_bytes];
-					bytes_read += 2;
-					cooked_bytes += 1;
-					section[image->num_sections].size += 1;
-					full_address++;
-				}
+				memcpy(&ihex->buffer[cooked_bytes], data, count);
+				cooked_bytes += count;
+				section[image->num_sections].size += count;
+				full_address += count;
 			} else if (record_type == 1) {	/* End of File Record */
 				/* finish the current section */
 				image->num_sections++;
@@ -216,15 +300,16 @@ static int image_ihex_buffer_complete_inner(struct image *image,
 
 				end_rec = true;
 				break;
-			} else if (record_type == 2) {	/* Linear Address Record */
-				uint16_t upper_address;
+			} else if (record_type == 2 || record_type == 4) {
+				/* Extended Segment / Extended Linear Address Record */
+				unsigned int shift = (record_type == 2) ? 4 : 16;
+				uint32_t upper_address;
 
-				sscanf(&lpszLine[bytes_read], "%4hx", &upper_address);
-				cal_checksum += (uint8_t)(upper_address >> 8);
-				cal_checksum += (uint8_t)upper_address;
-				bytes_read += 4;
+				if (count < 2)
+					return ERROR_IMAGE_FORMAT_ERROR;
+				upper_address = be_to_h_u16(data);
 
-				if ((full_address >> 4) != upper_address) {
+				if ((full_address >> shift) != upper_address) {
 					/* we encountered a nonconsecutive location, create a new section,
 					 * unless the current section has zero size, in which case this specifies
 					 * the current section's base address
@@ -242,76 +327,27 @@ static int image_ihex_buffer_complete_inner(struct image *image,
 							&ihex->buffer[cooked_bytes];
 					}
 					section[image->num_sections].base_address =
-						(full_address & 0xffff) | (upper_address << 4);
-					full_address = (full_address & 0xffff) | (upper_address << 4);
+						(full_address & 0xffff) | (upper_address << shift);
+					full_address = (full_address & 0xffff) | (upper_address << shift);
 				}
 			} else if (record_type == 3) {	/* Start Segment Address Record */
-				uint32_t dummy;
-
 				/* "Start Segment Address Record" will not be supported
 				 * but we must consume it, and do not create an error.  */
-				while (count-- > 0) {
-					sscanf(&lpszLine[bytes_read], "%2" SCNx32, &dummy);
-					cal_checksum += (uint8_t)dummy;
-					bytes_read += 2;
-				}
-			} else if (record_type == 4) {	/* Extended Linear Address Record */
-				uint16_t upper_address;
-
-				sscanf(&lpszLine[bytes_read], "%4hx", &upper_address);
-				cal_checksum += (uint8_t)(upper_address >> 8);
-				cal_checksum += (uint8_t)upper_address;
-				bytes_read += 4;
-
-				if ((full_address >> 16) != upper_address) {
-					/* we encountered a nonconsecutive location, create a new section,
-					 * unless the current section has zero size, in which case this specifies
-					 * the current section's base address
-					 */
-					if (section[image->num_sections].size != 0) {
-						image->num_sections++;
-						if (image->num_sections >= IMAGE_MAX_SECTIONS) {
-							/* too many sections */
-							LOG_ERROR("Too many sections found in IHEX file");
-							return ERROR_IMAGE_FORMAT_ERROR;
-						}
-						section[image->num_sections].size = 0x0;
-						section[image->num_sections].flags = 0;
-						section[image->num_sections].private =
-							&ihex->buffer[cooked_bytes];
-					}
-					section[image->num_sections].base_address =
-						(full_address & 0xffff) | (upper_address << 16);
-					full_address = (full_address & 0xffff) | (upper_address << 16);
-				}
 			} else if (record_type == 5) {	/* Start Linear Address Record */
-				uint32_t start_address;
-
-				sscanf(&lpszLine[bytes_read], "%8" SCNx32, &start_address);
-				cal_checksum += (uint8_t)(start_address >> 24);
-				cal_checksum += (uint8_t)(start_address >> 16);
-				cal_checksum += (uint8_t)(start_address >> 8);
-				cal_checksum += (uint8_t)start_address;
-				bytes_read += 8;
+				if (count < 4)
+					return ERROR_IMAGE_FORMAT_ERROR;
 
 				image->start_address_set = 1;
-				image->start_address = be_to_h_u32((uint8_t *)&start_address);
+				image->start_address = be_to_h_u32(data);
 			} else {
 				LOG_ERROR("unhandled IHEX record type: %i", (int)record_type);
 				return ERROR_IMAGE_FORMAT_ERROR;
 			}
 
-			sscanf(&lpszLine[bytes_read], "%2" SCNx32, &checksum);
-
-			if ((uint8_t)checksum != (uint8_t)(~cal_checksum + 1)) {
-				/* checksum failed */
-				LOG_ERROR("incorrect record checksum found in IHEX file");
-				return ERROR_IMAGE_CHECKSUM;
-			}
-
 			if (end_rec) {
 				end_rec = false;
-				LOG_WARNING("continuing after end-of-file record: %.40s", lpszLine);
+				LOG_WARNING("continuing after end-of-file record: %.*s",
+					(int)MIN(len, 40), line);
 			}
 		}
 	}
@@ -330,23 +366,16 @@ static int image_ihex_buffer_complete_inner(struct image *image,
  */
 static int image_ihex_buffer_complete(struct image *image)
 {
-	char *lpszLine = malloc(1023);
-	if (lpszLine == NULL) {
-		LOG_ERROR("Out of memory");
-		return ERROR_FAIL;
-	}
 	struct imagesection *section = malloc(sizeof(struct imagesection) * IMAGE_MAX_SECTIONS);
 	if (section == NULL) {
-		free(lpszLine);
 		LOG_ERROR("Out of memory");
 		return ERROR_FAIL;
 	}
 	int retval;
 
-	retval = image_ihex_buffer_complete_inner(image, lpszLine, section);
+	retval = image_ihex_buffer_complete_inner(image, section);
 
 	free(section);
-	free(lpszLine);
 
 	return retval;
 }
@@ -477,6 +506,29 @@ static int image_elf_read_headers(struct image *image)
 	return ERROR_OK;
 }
 
+/* View of @a size bytes at @a offset of a mapped image file */
+static int image_file_view(struct fileio *fileio, size_t offset, size_t size, uint8_t **data)
+{
+	size_t filesize;
+	uint8_t *map;
+	int retval;
+
+	retval = fileio_size(fileio, &filesize);
+	if (retval != ERROR_OK)
+		return retval;
+
+	if (offset > filesize || size > filesize - offset)
+		return ERROR_IMAGE_FORMAT_ERROR;
+
+	retval = fileio_map(fileio, &map);
+	if (retval != ERROR_OK)
+		return retval;
+
+	*data = map + offset;
+
+	return ERROR_OK;
+}
+
 static int image_elf_read_section(struct image *image,
 	int section,
 	uint32_t offset,
@@ -487,6 +539,7 @@ static int image_elf_read_section(struct image *image,
 	struct image_elf *elf = image->type_private;
 	Elf32_Phdr *segment = (Elf32_Phdr *)image->sections[section].private;
 	size_t read_size, really_read;
+	uint8_t *data;
 	int retval;
 
 	*size_read = 0;
@@ -499,6 +552,13 @@ static int image_elf_read_section(struct image *image,
 		read_size = MIN(size, field32(elf, segment->p_filesz) - offset);
 		LOG_DEBUG("read elf: size = 0x%zu at 0x%" PRIx32 "", read_size,
 			field32(elf, segment->p_offset) + offset);
+		/* copy from the mapped file if possible */
+		if (image_file_view(elf->fileio, field32(elf, segment->p_offset) + offset,
+				read_size, &data) == ERROR_OK) {
+			memcpy(buffer, data, read_size);
+			*size_read += read_size;
+			return ERROR_OK;
+		}
 		/* read initialized area of the segment */
 		retval = fileio_seek(elf->fileio, field32(elf, segment->p_offset) + offset);
 		if (retval != ERROR_OK) {
@@ -521,7 +581,6 @@ static int image_elf_read_section(struct image *image,
 }
 
 static int image_mot_buffer_complete_inner(struct image *image,
-	char *lpszLine,
 	struct imagesection *section)
 {
 	struct image_mot *mot = image->type_private;
@@ -529,6 +588,8 @@ static int image_mot_buffer_complete_inner(struct image *image,
 	uint32_t full_address;
 	uint32_t cooked_bytes;
 	bool end_rec = false;
+	const char *pos, *end, *line;
+	size_t len;
 	int i;
 
 	/* we can't determine the number of sections that we'll have to create ahead of time,
@@ -536,86 +597,77 @@ static int image_mot_buffer_complete_inner(struct image *image,
 
 	int retval;
 	size_t filesize;
+	uint8_t *content;
 	retval = fileio_size(fileio, &filesize);
 	if (retval != ERROR_OK)
 		return retval;
 
+	/* parse the whole file from memory rather than line by line through stdio */
+	retval = fileio_map(fileio, &content);
+	if (retval != ERROR_OK)
+		return retval;
+	pos = (const char *)content;
+	end = pos + filesize;
+
 	mot->buffer = malloc(filesize >> 1);
 	cooked_bytes = 0x0;
 	image->num_sections = 0;
 
-	while (!fileio_feof(fileio)) {
+	while (pos < end) {
 		full_address = 0x0;
 		section[image->num_sections].private = &mot->buffer[cooked_bytes];
 		section[image->num_sections].base_address = 0x0;
 		section[image->num_sections].size = 0x0;
 		section[image->num_sections].flags = 0;
 
-		while (fileio_fgets(fileio, 1023, lpszLine) == ERROR_OK) {
+		while (image_next_line(&pos, end, &line, &len)) {
+			/* byte count, address, data and checksum */
+			uint8_t record[1 + 255];
 			uint32_t count;
 			uint32_t address;
 			uint32_t record_type;
-			uint32_t checksum;
 			uint8_t cal_checksum = 0;
-			uint32_t bytes_read = 0;
 
 			/* skip comments and blank lines */
-			if ((lpszLine[0] == '#') || (strlen(lpszLine + strspn(lpszLine, "\n\t\r ")) == 0))
+			if (image_line_is_blank(line, len))
 				continue;
 
 			/* get record type and record length */
-			if (sscanf(&lpszLine[bytes_read], "S%1" SCNx32 "%2" SCNx32, &record_type,
-				&count) != 2)
+			if (len < 4 || line[0] != 'S' || !image_decode_hex(line + 2, 1, record))
+				return ERROR_IMAGE_FORMAT_ERROR;
+			record_type = image_hex_table()[(uint8_t)line[1]];
+			count = record[0];
+			if (record_type > 0xf || count < 1 || len < 4 + 2 * count
+					|| !image_decode_hex(line + 2, 1 + count, record))
 				return ERROR_IMAGE_FORMAT_ERROR;
 
-			bytes_read += 4;
-			cal_checksum += (uint8_t)count;
+			/* account for checksum, will always be 0xFF */
+			for (uint32_t j = 0; j <= count; j++)
+				cal_checksum += record[j];
+
+			if (cal_checksum != 0xFF) {
+				/* checksum failed */
+				LOG_ERROR("incorrect record checksum found in S19 file");
+				return ERROR_IMAGE_CHECKSUM;
+			}
 
 			/* skip checksum byte */
 			count -= 1;
 
 			if (record_type == 0) {
 				/* S0 - starting record (optional) */
-				int iValue;
-
-				while (count-- > 0) {
-					sscanf(&lpszLine[bytes_read], "%2x", &iValue);
-					cal_checksum += (uint8_t)iValue;
-					bytes_read += 2;
-				}
 			} else if (record_type >= 1 && record_type <= 3) {
-				switch (record_type) {
-					case 1:
-						/* S1 - 16 bit address data record */
-						sscanf(&lpszLine[bytes_read], "%4" SCNx32, &address);
-						cal_checksum += (uint8_t)(address >> 8);
-						cal_checksum += (uint8_t)address;
-						bytes_read += 4;
-						count -= 2;
-						break;
-
-					case 2:
-						/* S2 - 24 bit address data record */
-						sscanf(&lpszLine[bytes_read], "%6" SCNx32, &address);
-						cal_checksum += (uint8_t)(address >> 16);
-						cal_checksum += (uint8_t)(address >> 8);
-						cal_checksum += (uint8_t)address;
-						bytes_read += 6;
-						count -= 3;
-						break;
-
-					case 3:
-						/* S3 - 32 bit address data record */
-						sscanf(&lpszLine[bytes_read], "%8" SCNx32, &address);
-						cal_checksum += (uint8_t)(address >> 24);
-						cal_checksum += (uint8_t)(address >> 16);
-						cal_checksum += (uint8_t)(address >> 8);
-						cal_checksum += (uint8_t)address;
-						bytes_read += 8;
-						count -= 4;
-						break;
+				/* S1, S2, S3 - 16, 24 and 32 bit address data records */
+				uint32_t address_bytes = record_type + 1;
+				uint8_t *data = &record[1 + address_bytes];
 
-				}
+				if (count < address_bytes)
+					return ERROR_IMAGE_FORMAT_ERROR;
+
+				address = 0;
+				for (uint32_t j = 0; j < address_bytes; j++)
+					address = (address << 8) | record[1 + j];
+				count -= address_bytes;
 
 				if (full_address != address) {
 					/* we encountered a nonconsecutive location, create a new section,
@@ -624,6 +676,11 @@ static int image_mot_buffer_complete_inner(struct image *image,
 					 */
 					if (section[image->num_sections].size != 0) {
 						image->num_sections++;
+						if (image->num_sections >= IMAGE_MAX_SECTIONS) {
+							/* too many sections */
+							LOG_ERROR("Too many sections found in S19 file");
+							return ERROR_IMAGE_FORMAT_ERROR;
+						}
 						section[image->num_sections].size = 0x0;
 						section[image->num_sections].flags = 0;
 						section[image->num_sections].private =
@@ -633,25 +690,12 @@ static int image_mot_buffer_complete_inner(struct image *image,
 					full_address = address;
 				}
 
-				while (count-- > 0) {
-					unsigned value;
-					sscanf(&lpszLine[bytes_read], "%2x", &value);
-					mot->buffer[cooked_bytes] = (uint8_t)value;
-					cal_checksum += (uint8_t)mot->buffer[cooked_bytes];
-					bytes_read += 2;
-					cooked_bytes += 1;
-					section[image->num_sections].size += 1;
-					full_address++;
-				}
+				memcpy(&mot->buffer[cooked_bytes], data, count);
+				cooked_bytes += count;
+				section[image->num_sections].size += count;
+				full_address += count;
 			} else if (record_type == 5 || record_type == 6) {
 				/* S5 and S6 are the data count records, we ignore them */
-				uint32_t dummy;
-
-				while (count-- > 0) {
-					sscanf(&lpszLine[bytes_read], "%2" SCNx32, &dummy);
-					cal_checksum += (uint8_t)dummy;
-					bytes_read += 2;
-				}
 			} else if (record_type >= 7 && record_type <= 9) {
 				/* S7, S8, S9 - ending records for 32, 24 and 16bit */
 				image->num_sections++;
@@ -672,19 +716,10 @@ static int image_mot_buffer_complete_inner(struct image *image,
 				return ERROR_IMAGE_FORMAT_ERROR;
 			}
 
-			/* account for checksum, will always be 0xFF */
-			sscanf(&lpszLine[bytes_read], "%2" SCNx32, &checksum);
-			cal_checksum += (uint8_t)checksum;
-
-			if (cal_checksum != 0xFF) {
-				/* checksum failed */
-				LOG_ERROR("incorrect record checksum found in S19 file");
-				return ERROR_IMAGE_CHECKSUM;
-			}
-
 			if (end_rec) {
 				end_rec = false;
-				LOG_WARNING("continuing after end-of-file record: %.40s", lpszLine);
+				LOG_WARNING("continuing after end-of-file record: %.*s",
+					(int)MIN(len, 40), line);
 			}
 		}
 	}
@@ -703,23 +738,16 @@ static int image_mot_buffer_complete_inner(struct image *image,
  */
 static int image_mot_buffer_complete(struct image *image)
 {
-	char *lpszLine = malloc(1023);
-	if (lpszLine == NULL) {
-		LOG_ERROR("Out of memory");
-		return ERROR_FAIL;
-	}
 	struct imagesection *section = malloc(sizeof(struct imagesection) * IMAGE_MAX_SECTIONS);
 	if (section == NULL) {
-		free(lpszLine);
 		LOG_ERROR("Out of memory");
 		return ERROR_FAIL;
 	}
 	int retval;
 
-	retval = image_mot_buffer_complete_inner(image, lpszLine, section);
+	retval = image_mot_buffer_complete_inner(image, section);
 
 	free(section);
-	free(lpszLine);
 
 	return retval;
 }
@@ -867,6 +895,13 @@ int image_read_section(struct image *image,
 		if (section != 0)
 			return ERROR_COMMAND_SYNTAX_ERROR;
 
+		uint8_t *data;
+		if (image_file_view(image_binary->fileio, offset, size, &data) == ERROR_OK) {
+			memcpy(buffer, data, size);
+			*size_read = size;
+			return ERROR_OK;
+		}
+
 		/* seek to offset */
 		retval = fileio_seek(image_binary->fileio, offset);
 		if (retval != ERROR_OK)
@@ -936,6 +971,48 @@ int image_read_section(struct image *image,
 	return ERROR_OK;
 }
 
+/**
+ * Get a pointer to image content without copying it.
+ *
+ * File backed images are mapped on first use; buffered formats hand out
+ * their decoded section data. The view stays valid until image_close()
+ * and must be treated as read-only.
+ *
+ * @returns ERROR_OK and sets @a data on success, or an error code when no
+ * view is available (e.g. for IMAGE_MEMORY), in which case the caller has
+ * to fall back to image_read_section().
+ */
+int image_get_section_view(struct image *image,
+	int section,
+	uint32_t offset,
+	uint32_t size,
+	uint8_t **data)
+{
+	if (offset + size > image->sections[section].size)
+		return ERROR_COMMAND_SYNTAX_ERROR;
+
+	if (image->type == IMAGE_BINARY) {
+		struct image_binary *image_binary = image->type_private;
+
+		if (section != 0)
+			return ERROR_COMMAND_SYNTAX_ERROR;
+
+		return image_file_view(image_binary->fileio, offset, size, data);
+	} else if (image->type == IMAGE_ELF) {
+		struct image_elf *elf = image->type_private;
+		Elf32_Phdr *segment = image->sections[section].private;
+
+		return image_file_view(elf->fileio, field32(elf, segment->p_offset) + offset,
+				size, data);
+	} else if (image->type == IMAGE_IHEX || image->type == IMAGE_SRECORD
+			|| image->type == IMAGE_BUILDER) {
+		*data = (uint8_t *)image->sections[section].private + offset;
+		return ERROR_OK;
+	}
+
+	return ERROR_FAIL;
+}
+
 int image_add_section(struct image *image, uint32_t base, uint32_t size, int flags, uint8_t const *data)
 {
 	struct imagesection *section;
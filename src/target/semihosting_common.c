@@ -67,6 +67,17 @@ static const int open_modeflags[12] = {
 	O_RDWR | O_CREAT | O_APPEND | O_BINARY
 };
 
+/* console output is buffered up to this size, and for at most this long */
+#define SEMIHOSTING_CONSOLE_BUF_SIZE	4096
+#define SEMIHOSTING_CONSOLE_FLUSH_MS	50
+
+/* strings are read in aligned chunks of this size, which is the smallest
+ * protection granule, so that reading past the NUL cannot fault */
+#define SEMIHOSTING_STRING_CHUNK	32
+
+/* upper limit for the number of operations in a batch */
+#define SEMIHOSTING_BATCH_MAX		256
+
 static int semihosting_common_fileio_info(struct target *target,
 	struct gdb_fileio_info *fileio_info);
 static int semihosting_common_fileio_end(struct target *target, int result,
@@ -121,6 +132,11 @@ int semihosting_common_init(struct target *target, void *setup,
 	semihosting->result = -1;
 	semihosting->sys_errno = -1;
 	semihosting->cmdline = NULL;
+	semihosting->console_fd = -1;
+	semihosting->console_len = 0;
+	semihosting->console_buf = NULL;
+	semihosting->console_timer = false;
+	semihosting->console_fds = 0;
 
 	/* If possible, update it in setup(). */
 	semihosting->setup_time = clock();
@@ -136,6 +152,135 @@ int semihosting_common_init(struct target *target, void *setup,
 	return ERROR_OK;
 }
 
+void semihosting_common_free(struct target *target)
+{
+	struct semihosting *semihosting = target->semihosting;
+
+	semihosting_console_flush(target);
+
+	free(semihosting->console_buf);
+	free(semihosting->cmdline);
+	free(semihosting);
+	target->semihosting = NULL;
+}
+
+bool semihosting_is_operation(int op)
+{
+	return (0 <= op && op <= 0x31) || op == SEMIHOSTING_USER_BATCH;
+}
+
+static int semihosting_console_timer(void *priv)
+{
+	struct target *target = priv;
+
+	/* one-shot, the timer is gone when this returns */
+	target->semihosting->console_timer = false;
+	semihosting_console_flush(target);
+
+	return ERROR_OK;
+}
+
+void semihosting_console_flush(struct target *target)
+{
+	struct semihosting *semihosting = target->semihosting;
+	size_t done = 0;
+
+	if (semihosting->console_timer) {
+		target_unregister_timer_callback(semihosting_console_timer, target);
+		semihosting->console_timer = false;
+	}
+
+	while (done < semihosting->console_len) {
+		ssize_t n = write(semihosting->console_fd, semihosting->console_buf + done,
+				semihosting->console_len - done);
+		if (n < 0) {
+			if (errno == EINTR)
+				continue;
+			LOG_ERROR("semihosting: console write failed: %s", strerror(errno));
+			break;
+		}
+		done += n;
+	}
+
+	semihosting->console_len = 0;
+}
+
+/* Queue console output to host file @a fd */
+static void semihosting_console_write(struct target *target, int fd,
+	const uint8_t *data, size_t len)
+{
+	struct semihosting *semihosting = target->semihosting;
+
+	if (semihosting->console_len &&
+			(fd != semihosting->console_fd ||
+			 semihosting->console_len + len > SEMIHOSTING_CONSOLE_BUF_SIZE))
+		semihosting_console_flush(target);
+
+	if (semihosting->console_buf == NULL)
+		semihosting->console_buf = malloc(SEMIHOSTING_CONSOLE_BUF_SIZE);
+
+	if (semihosting->console_buf == NULL || len > SEMIHOSTING_CONSOLE_BUF_SIZE) {
+		/* too large to buffer, write it out right away */
+		while (len > 0) {
+			ssize_t n = write(fd, data, len);
+			if (n < 0) {
+				if (errno == EINTR)
+					continue;
+				LOG_ERROR("semihosting: console write failed: %s", strerror(errno));
+				return;
+			}
+			data += n;
+			len -= n;
+		}
+		return;
+	}
+
+	memcpy(semihosting->console_buf + semihosting->console_len, data, len);
+	semihosting->console_fd = fd;
+	semihosting->console_len += len;
+
+	if (!semihosting->console_timer &&
+			target_register_timer_callback(semihosting_console_timer,
+				SEMIHOSTING_CONSOLE_FLUSH_MS, 0, target) == ERROR_OK)
+		semihosting->console_timer = true;
+}
+
+static bool semihosting_is_console_fd(struct semihosting *semihosting, int fd)
+{
+	return fd >= 0 && fd < 64 && (semihosting->console_fds & (1ULL << fd));
+}
+
+/**
+ * Find the NUL terminated string at @a addr, reading it in chunks rather
+ * than byte by byte, and queue it for the console if @a output is set.
+ */
+static int semihosting_read_string(struct target *target, uint64_t addr,
+	bool output, size_t *count)
+{
+	uint8_t chunk[SEMIHOSTING_STRING_CHUNK];
+
+	*count = 0;
+
+	for (;;) {
+		size_t len = SEMIHOSTING_STRING_CHUNK - (addr % SEMIHOSTING_STRING_CHUNK);
+		int retval = target_read_buffer(target, addr, len, chunk);
+		if (retval != ERROR_OK)
+			return retval;
+
+		uint8_t *end = memchr(chunk, '\0', len);
+		size_t n = end ? (size_t)(end - chunk) : len;
+
+		if (output && n)
+			semihosting_console_write(target, STDOUT_FILENO, chunk, n);
+
+		*count += n;
+		addr += n;
+
+		if (end)
+			return ERROR_OK;
+	}
+}
+
 /**
  * Portable implementation of ARM semihosting calls.
  * Performs the currently pending semihosting operation
@@ -168,6 +313,14 @@ int semihosting_common(struct target *target)
 	LOG_DEBUG("op=0x%x, param=0x%" PRIx64, (int)semihosting->op,
 		semihosting->param);
 
+	/* console output has to appear before anything else happens */
+	if (semihosting->console_len &&
+			semihosting->op != SEMIHOSTING_SYS_WRITE &&
+			semihosting->op != SEMIHOSTING_SYS_WRITEC &&
+			semihosting->op != SEMIHOSTING_SYS_WRITE0 &&
+			semihosting->op != SEMIHOSTING_USER_BATCH)
+		semihosting_console_flush(target);
+
 	switch (semihosting->op) {
 
 		case SEMIHOSTING_SYS_CLOCK:	/* 0x10 */
@@ -233,6 +386,10 @@ int semihosting_common(struct target *target)
 					fileio_info->identifier = "close";
 					fileio_info->param_1 = fd;
 				} else {
+					if (semihosting_is_console_fd(semihosting, fd)) {
+						semihosting_console_flush(target);
+						semihosting->console_fds &= ~(1ULL << fd);
+					}
 					semihosting->result = close(fd);
 					semihosting->sys_errno = errno;
 
@@ -739,6 +896,10 @@ int semihosting_common(struct target *target)
 								LOG_DEBUG("dup(STDERR)=%d",
 									(int)semihosting->result);
 							}
+							if (mode >= 4 && semihosting->result >= 0 &&
+									semihosting->result < 64)
+								semihosting->console_fds |=
+									1ULL << semihosting->result;
 						} else {
 							/* cygwin requires the permission setting
 							 * otherwise it will fail to reopen a previously
@@ -1152,6 +1313,13 @@ int semihosting_common(struct target *target)
 							free(buf);
 							return retval;
 						}
+						if (semihosting_is_console_fd(semihosting, fd)) {
+							semihosting_console_write(target, fd, buf, len);
+							semihosting->result = 0;
+							free(buf);
+							break;
+						}
+						semihosting_console_flush(target);
 						semihosting->result = write(fd, buf, len);
 						semihosting->sys_errno = errno;
 						LOG_DEBUG("write(%d, 0x%" PRIx64 ", %zu)=%d",
@@ -1197,7 +1365,7 @@ int semihosting_common(struct target *target)
 				retval = target_read_memory(target, addr, 1, 1, &c);
 				if (retval != ERROR_OK)
 					return retval;
-				putchar(c);
+				semihosting_console_write(target, STDOUT_FILENO, &c, 1);
 				semihosting->result = 0;
 			}
 			break;
@@ -1216,34 +1384,114 @@ int semihosting_common(struct target *target)
 			 * None. The RETURN REGISTER is corrupted.
 			 */
 			if (semihosting->is_fileio) {
-				size_t count = 0;
-				uint64_t addr = semihosting->param;
-				for (;; addr++) {
-					unsigned char c;
-					retval = target_read_memory(target, addr, 1, 1, &c);
-					if (retval != ERROR_OK)
-						return retval;
-					if (c == '\0')
-						break;
-					count++;
-				}
+				size_t count;
+				retval = semihosting_read_string(target, semihosting->param,
+						false, &count);
+				if (retval != ERROR_OK)
+					return retval;
 				semihosting->hit_fileio = true;
 				fileio_info->identifier = "write";
 				fileio_info->param_1 = 1;
 				fileio_info->param_2 = semihosting->param;
 				fileio_info->param_3 = count;
 			} else {
-				uint64_t addr = semihosting->param;
-				do {
-					unsigned char c;
-					retval = target_read_memory(target, addr++, 1, 1, &c);
+				size_t count;
+				retval = semihosting_read_string(target, semihosting->param,
+						true, &count);
+				if (retval != ERROR_OK)
+					return retval;
+				semihosting->result = 0;
+			}
+			break;
+
+		case SEMIHOSTING_USER_BATCH:	/* 0x100 */
+			/*
+			 * Performs several operations in one trap, e.g. the console
+			 * writes a target library queued up, saving a halt and resume
+			 * per operation.
+			 *
+			 * Entry
+			 * On entry, the PARAMETER REGISTER contains a pointer to a
+			 * two-field data block:
+			 * - field 1 Points to an array of operations, each of three
+			 * fields: the operation number, its PARAMETER REGISTER value,
+			 * and room for its RETURN REGISTER value.
+			 * - field 2 Contains the number of operations.
+			 *
+			 * Return
+			 * On exit, the RETURN REGISTER contains the number of
+			 * operations performed, with the result of each stored in
+			 * its third field. Processing stops at an operation that
+			 * cannot be batched: the exit calls, batches, and anything
+			 * while semihosting fileio is active. -1 is returned if
+			 * the block cannot be read.
+			 */
+			if (semihosting->is_fileio) {
+				semihosting->result = -1;
+				semihosting->sys_errno = ENOSYS;
+				break;
+			}
+			retval = semihosting_read_fields(target, 2, fields);
+			if (retval != ERROR_OK)
+				return retval;
+			else {
+				uint64_t addr = semihosting_get_field(target, 0, fields);
+				size_t count = semihosting_get_field(target, 1, fields);
+				size_t entry_size = 3 * semihosting->word_size_bytes;
+				int op = semihosting->op;
+				uint64_t param = semihosting->param;
+				size_t done;
+
+				if (count > SEMIHOSTING_BATCH_MAX) {
+					semihosting->result = -1;
+					semihosting->sys_errno = EINVAL;
+					break;
+				}
+
+				uint8_t *entries = malloc(count * entry_size);
+				if (!entries) {
+					semihosting->result = -1;
+					semihosting->sys_errno = ENOMEM;
+					break;
+				}
+
+				retval = target_read_buffer(target, addr, count * entry_size, entries);
+				if (retval != ERROR_OK) {
+					free(entries);
+					return retval;
+				}
+
+				for (done = 0; done < count; done++) {
+					uint8_t *entry = entries + done * entry_size;
+
+					semihosting->op = semihosting_get_field(target, 0, entry);
+					semihosting->param = semihosting_get_field(target, 1, entry);
+
+					if (!semihosting_is_operation(semihosting->op) ||
+							semihosting->op == SEMIHOSTING_USER_BATCH ||
+							semihosting->op == SEMIHOSTING_SYS_EXIT ||
+							semihosting->op == SEMIHOSTING_SYS_EXIT_EXTENDED)
+						break;
+
+					retval = semihosting_common(target);
 					if (retval != ERROR_OK)
-						return retval;
-					if (!c)
 						break;
-					putchar(c);
-				} while (1);
-				semihosting->result = 0;
+
+					semihosting_set_field(target, semihosting->result, 2, entry);
+				}
+
+				semihosting->op = op;
+				semihosting->param = param;
+
+				if (retval == ERROR_OK && done > 0)
+					retval = target_write_buffer(target, addr, done * entry_size,
+							entries);
+				free(entries);
+				if (retval != ERROR_OK)
+					return retval;
+
+				semihosting->result = done;
+				semihosting->is_resumable = true;
 			}
 			break;
 
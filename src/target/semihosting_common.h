@@ -74,6 +74,12 @@ enum semihosting_operation_numbers {
 	SEMIHOSTING_SYS_WRITE = 0x05,
 	SEMIHOSTING_SYS_WRITEC = 0x03,
 	SEMIHOSTING_SYS_WRITE0 = 0x04,
+
+	/*
+	 * OpenOCD extension, in the range reserved for user applications:
+	 * several operations passed in one trap.
+	 */
+	SEMIHOSTING_USER_BATCH = 0x100,
 };
 
 /*
@@ -152,12 +158,30 @@ struct semihosting {
 	/** The current time when 'execution starts' */
 	clock_t setup_time;
 
+	/**
+	 * Console output not written to the host yet. It is flushed when
+	 * full, before any other operation and shortly after the last write.
+	 */
+	int console_fd;
+	size_t console_len;
+	uint8_t *console_buf;
+	bool console_timer;
+
+	/** Host file descriptors below 64 opened on ":tt", written through
+	 * the console buffer */
+	uint64_t console_fds;
+
 	int (*setup)(struct target *target, int enable);
 	int (*post_result)(struct target *target);
 };
 
 int semihosting_common_init(struct target *target, void *setup,
 	void *post_result);
+void semihosting_common_free(struct target *target);
 int semihosting_common(struct target *target);
+/** @returns true if @a op is handled by semihosting_common() */
+bool semihosting_is_operation(int op);
+/** Write out buffered console output */
+void semihosting_console_flush(struct target *target);
 
 #endif	/* OPENOCD_TARGET_SEMIHOSTING_COMMON_H */
@@ -42,6 +42,7 @@
 #endif
 
 #include <helper/time_support.h>
+#include <helper/perf.h>
 #include <jtag/jtag.h>
 #include <flash/nor/core.h>
 
@@ -55,6 +56,7 @@
 #include "rtos/rtos.h"
 #include "transport/transport.h"
 #include "arm_cti.h"
+#include "semihosting_common.h"
 
 /* default halt wait timeout (ms) */
 #define DEFAULT_HALT_TIMEOUT 5000
@@ -153,7 +155,15 @@ static struct target_type *target_types[] = {
 
 struct target *all_targets;
 static struct target_event_callback *target_event_callbacks;
-static struct target_timer_callback *target_timer_callbacks;
+/* timer callbacks, as a binary min-heap ordered by deadline */
+static struct target_timer_callback **target_timer_callbacks;
+static unsigned target_timer_callback_count;
+static unsigned target_timer_callback_size;
+static struct target_timer_callback *target_timer_callback_running;
+
+/* interval range of adaptive timer callbacks, see "adaptive_poll" */
+static int adaptive_poll_min_ms = 1;
+static int adaptive_poll_max_ms = 64;
 LIST_HEAD(target_reset_callback_list);
 LIST_HEAD(target_trace_callback_list);
 static const int polling_interval = 100;
@@ -583,6 +593,8 @@ int target_halt(struct target *target)
 	return ERROR_OK;
 }
 
+static bool target_evict_resident_algorithms(struct target *target);
+
 /**
  * Make the target (re)start executing using its saved execution
  * context (possibly with some modifications).
@@ -624,6 +636,11 @@ int target_resume(struct target *target, int current, target_addr_t address,
 		return ERROR_FAIL;
 	}
 
+	/* whatever runs may overwrite idle resident algorithms, only the
+	 * one being run (if any) is known to stay intact */
+	if (target->resident_algorithms)
+		target_evict_resident_algorithms(target);
+
 	target_call_event_callbacks(target, TARGET_EVENT_RESUME_START);
 
 	/* note that resume *must* be asynchronous. The CPU can halt before
@@ -810,6 +827,9 @@ int target_run_algorithm(struct target *target,
 		goto done;
 	}
 
+	static struct perf_stat algorithm_stat = PERF_STAT_INIT("target.algorithm");
+	int64_t start = perf_start();
+
 	target->running_alg = true;
 	retval = target->type->run_algorithm(target,
 			num_mem_params, mem_params,
@@ -817,6 +837,8 @@ int target_run_algorithm(struct target *target,
 			entry_point, exit_point, timeout_ms, arch_info);
 	target->running_alg = false;
 
+	perf_end(&algorithm_stat, start, 1, 0, retval);
+
 done:
 	return retval;
 }
@@ -1113,6 +1135,9 @@ int target_read_phys_memory(struct target *target,
 	return target->type->read_phys_memory(target, address, size, count, buffer);
 }
 
+static void target_check_resident_algorithms(struct target *target,
+		target_addr_t address, uint32_t size);
+
 int target_write_memory(struct target *target,
 		target_addr_t address, uint32_t size, uint32_t count, const uint8_t *buffer)
 {
@@ -1124,6 +1149,8 @@ int target_write_memory(struct target *target,
 		LOG_ERROR("Target %s doesn't support write_memory", target_name(target));
 		return ERROR_FAIL;
 	}
+	if (target->resident_algorithms)
+		target_check_resident_algorithms(target, address, size * count);
 	return target->type->write_memory(target, address, size, count, buffer);
 }
 
@@ -1138,6 +1165,9 @@ int target_write_phys_memory(struct target *target,
 		LOG_ERROR("Target %s doesn't support write_phys_memory", target_name(target));
 		return ERROR_FAIL;
 	}
+	/* working areas may be set up by virtual address, be conservative */
+	if (target->resident_algorithms)
+		target_evict_resident_algorithms(target);
 	return target->type->write_phys_memory(target, address, size, count, buffer);
 }
 
@@ -1235,6 +1265,10 @@ bool target_supports_gdb_connection(struct target *target)
 int target_step(struct target *target,
 		int current, target_addr_t address, int handle_breakpoints)
 {
+	/* stepping runs firmware which may use the working area RAM */
+	if (target->resident_algorithms)
+		target_evict_resident_algorithms(target);
+
 	return target->type->step(target, current, address, handle_breakpoints);
 }
 
@@ -1460,34 +1494,147 @@ int target_register_trace_callback(int (*callback)(struct target *target,
 	return ERROR_OK;
 }
 
-int target_register_timer_callback(int (*callback)(void *priv), int time_ms, int periodic, void *priv)
+/* Earlier deadline first; on a tie, callbacks not yet called in the
+ * current run go before those that were */
+static bool target_timer_before(unsigned a, unsigned b)
+{
+	struct target_timer_callback *x = target_timer_callbacks[a];
+	struct target_timer_callback *y = target_timer_callbacks[b];
+
+	return x->when < y->when || (x->when == y->when && x->pass < y->pass);
+}
+
+static void target_timer_heap_swap(unsigned a, unsigned b)
+{
+	struct target_timer_callback *tmp = target_timer_callbacks[a];
+
+	target_timer_callbacks[a] = target_timer_callbacks[b];
+	target_timer_callbacks[b] = tmp;
+	target_timer_callbacks[a]->heap_index = a;
+	target_timer_callbacks[b]->heap_index = b;
+}
+
+/* Restore the heap order around @a i after its deadline changed */
+static void target_timer_heap_fix(unsigned i)
+{
+	while (i > 0) {
+		unsigned parent = (i - 1) / 2;
+		if (!target_timer_before(i, parent))
+			break;
+		target_timer_heap_swap(i, parent);
+		i = parent;
+	}
+
+	for (;;) {
+		unsigned smallest = i;
+		unsigned left = 2 * i + 1;
+		unsigned right = left + 1;
+
+		if (left < target_timer_callback_count && target_timer_before(left, smallest))
+			smallest = left;
+		if (right < target_timer_callback_count && target_timer_before(right, smallest))
+			smallest = right;
+		if (smallest == i)
+			break;
+		target_timer_heap_swap(i, smallest);
+		i = smallest;
+	}
+}
+
+static void target_timer_heap_remove(struct target_timer_callback *cb)
+{
+	unsigned i = cb->heap_index;
+
+	target_timer_callback_count--;
+	if (i != target_timer_callback_count) {
+		target_timer_callbacks[i] = target_timer_callbacks[target_timer_callback_count];
+		target_timer_callbacks[i]->heap_index = i;
+		target_timer_heap_fix(i);
+	}
+}
+
+static struct target_timer_callback *target_add_timer_callback(
+		int (*callback)(void *priv), int time_ms, int periodic, void *priv)
 {
-	struct target_timer_callback **callbacks_p = &target_timer_callbacks;
+	struct target_timer_callback *cb;
 
+	if (target_timer_callback_count == target_timer_callback_size) {
+		unsigned size = target_timer_callback_size ? 2 * target_timer_callback_size : 16;
+		struct target_timer_callback **heap = realloc(target_timer_callbacks,
+				size * sizeof(*heap));
+		if (heap == NULL)
+			return NULL;
+		target_timer_callbacks = heap;
+		target_timer_callback_size = size;
+	}
+
+	cb = calloc(1, sizeof(*cb));
+	if (cb == NULL)
+		return NULL;
+
+	cb->callback = callback;
+	cb->periodic = periodic;
+	cb->time_ms = time_ms;
+	cb->removed = false;
+	cb->when = monotonic_us() + time_ms * 1000LL;
+	cb->priv = priv;
+
+	cb->heap_index = target_timer_callback_count++;
+	target_timer_callbacks[cb->heap_index] = cb;
+	target_timer_heap_fix(cb->heap_index);
+
+	return cb;
+}
+
+int target_register_timer_callback(int (*callback)(void *priv), int time_ms, int periodic, void *priv)
+{
 	if (callback == NULL)
 		return ERROR_COMMAND_SYNTAX_ERROR;
 
-	if (*callbacks_p) {
-		while ((*callbacks_p)->next)
-			callbacks_p = &((*callbacks_p)->next);
-		callbacks_p = &((*callbacks_p)->next);
-	}
+	if (target_add_timer_callback(callback, time_ms, periodic, priv) == NULL)
+		return ERROR_FAIL;
 
-	(*callbacks_p) = malloc(sizeof(struct target_timer_callback));
-	(*callbacks_p)->callback = callback;
-	(*callbacks_p)->periodic = periodic;
-	(*callbacks_p)->time_ms = time_ms;
-	(*callbacks_p)->removed = false;
+	return ERROR_OK;
+}
 
-	gettimeofday(&(*callbacks_p)->when, NULL);
-	timeval_add_time(&(*callbacks_p)->when, 0, time_ms * 1000);
+int target_register_adaptive_timer_callback(int (*callback)(void *priv), int max_ms, void *priv)
+{
+	struct target_timer_callback *cb;
 
-	(*callbacks_p)->priv = priv;
-	(*callbacks_p)->next = NULL;
+	if (callback == NULL)
+		return ERROR_COMMAND_SYNTAX_ERROR;
+
+	cb = target_add_timer_callback(callback, adaptive_poll_min_ms, 1, priv);
+	if (cb == NULL)
+		return ERROR_FAIL;
+
+	cb->adaptive = true;
+	cb->max_ms = max_ms;
 
 	return ERROR_OK;
 }
 
+void target_timer_callback_active(void)
+{
+	if (target_timer_callback_running)
+		target_timer_callback_running->active = true;
+}
+
+/* Poll again right away while there is traffic, back off exponentially
+ * up to the maximum interval while there is none */
+static void target_adapt_timer_callback(struct target_timer_callback *cb)
+{
+	int max_ms = cb->max_ms ? cb->max_ms : adaptive_poll_max_ms;
+
+	if (cb->active)
+		cb->time_ms = adaptive_poll_min_ms;
+	else
+		cb->time_ms = MIN(MAX(2 * cb->time_ms, 1), max_ms);
+
+	cb->time_ms = MAX(cb->time_ms, adaptive_poll_min_ms);
+	cb->active = false;
+}
+
 int target_unregister_event_callback(int (*callback)(struct target *target,
 		enum target_event event, void *priv), void *priv)
 {
@@ -1554,10 +1701,15 @@ int target_unregister_timer_callback(int (*callback)(void *priv), void *priv)
 	if (callback == NULL)
 		return ERROR_COMMAND_SYNTAX_ERROR;
 
-	for (struct target_timer_callback *c = target_timer_callbacks;
-	     c; c = c->next) {
-		if ((c->callback == callback) && (c->priv == priv)) {
+	for (unsigned i = 0; i < target_timer_callback_count; i++) {
+		struct target_timer_callback *c = target_timer_callbacks[i];
+		if ((c->callback == callback) && (c->priv == priv) && !c->removed) {
+			/* a running callback is freed by its caller when it returns */
 			c->removed = true;
+			if (c != target_timer_callback_running) {
+				target_timer_heap_remove(c);
+				free(c);
+			}
 			return ERROR_OK;
 		}
 	}
@@ -1612,28 +1764,47 @@ int target_call_trace_callbacks(struct target *target, size_t len, uint8_t *data
 	return ERROR_OK;
 }
 
-static int target_timer_callback_periodic_restart(
-		struct target_timer_callback *cb, struct timeval *now)
-{
-	cb->when = *now;
-	timeval_add_time(&cb->when, 0, cb->time_ms * 1000L);
-	return ERROR_OK;
-}
-
 static int target_call_timer_callback(struct target_timer_callback *cb,
-		struct timeval *now)
-{
-	cb->callback(cb->priv);
+		int64_t now)
+{
+	static struct perf_stat timer_stat = PERF_STAT_INIT("timer.callback");
+	static struct perf_stat poll_stat = PERF_STAT_INIT("target.poll");
+	int64_t start = perf_start();
+	int64_t begin = monotonic_us();
+
+	target_timer_callback_running = cb;
+	int retval = cb->callback(cb->priv);
+	target_timer_callback_running = NULL;
+
+	int64_t elapsed = monotonic_us() - begin;
+	cb->calls++;
+	cb->total_us += elapsed;
+	if (elapsed > cb->max_us)
+		cb->max_us = elapsed;
+
+	/* polling the targets is the timer callback everybody has */
+	perf_end(cb->callback == handle_target ? &poll_stat : &timer_stat,
+		start, 1, 0, retval);
+
+	if (cb->periodic && !cb->removed) {
+		if (cb->adaptive)
+			target_adapt_timer_callback(cb);
+		cb->when = now + cb->time_ms * 1000LL;
+		target_timer_heap_fix(cb->heap_index);
+		return ERROR_OK;
+	}
 
-	if (cb->periodic)
-		return target_timer_callback_periodic_restart(cb, now);
+	/* one-shot, or unregistered from within the callback */
+	target_timer_heap_remove(cb);
+	free(cb);
 
-	return target_unregister_timer_callback(cb->callback, cb->priv);
+	return ERROR_OK;
 }
 
 static int target_call_timer_callbacks_check_time(int checktime)
 {
 	static bool callback_processing;
+	static uint64_t pass;
 
 	/* Do not allow nesting */
 	if (callback_processing)
@@ -1643,29 +1814,31 @@ static int target_call_timer_callbacks_check_time(int checktime)
 
 	keep_alive();
 
-	struct timeval now;
-	gettimeofday(&now, NULL);
-
-	/* Store an address of the place containing a pointer to the
-	 * next item; initially, that's a standalone "root of the
-	 * list" variable. */
-	struct target_timer_callback **callback = &target_timer_callbacks;
-	while (*callback) {
-		if ((*callback)->removed) {
-			struct target_timer_callback *p = *callback;
-			*callback = (*callback)->next;
-			free(p);
-			continue;
+	int64_t now = monotonic_us();
+
+	/* callbacks rescheduled during this run must wait for the next one */
+	pass++;
+
+	if (!checktime) {
+		/* make every periodic callback due right now */
+		for (unsigned i = 0; i < target_timer_callback_count; i++) {
+			struct target_timer_callback *cb = target_timer_callbacks[i];
+			if (cb->periodic && cb->when > now) {
+				cb->when = now;
+				target_timer_heap_fix(i);
+			}
 		}
+	}
 
-		bool call_it = (*callback)->callback &&
-			((!checktime && (*callback)->periodic) ||
-			 timeval_compare(&now, &(*callback)->when) >= 0);
+	while (target_timer_callback_count > 0) {
+		struct target_timer_callback *cb = target_timer_callbacks[0];
 
-		if (call_it)
-			target_call_timer_callback(*callback, &now);
+		if (cb->when > now || cb->pass == pass)
+			break;
 
-		callback = &(*callback)->next;
+		cb->pass = pass;
+		target_timer_heap_fix(0);
+		target_call_timer_callback(cb, now);
 	}
 
 	callback_processing = false;
@@ -1683,6 +1856,14 @@ int target_call_timer_callbacks_now(void)
 	return target_call_timer_callbacks_check_time(0);
 }
 
+int64_t target_timer_next_event(void)
+{
+	if (target_timer_callback_count == 0)
+		return INT64_MAX;
+
+	return target_timer_callbacks[0]->when;
+}
+
 /* Prints the working area layout for debug purposes */
 static void print_wa_layout(struct target *target)
 {
@@ -1760,6 +1941,51 @@ static void target_merge_working_areas(struct target *target)
 	}
 }
 
+static void target_prune_resident_algorithms(struct target *target)
+{
+	struct resident_algorithm **p = &target->resident_algorithms;
+
+	while (*p) {
+		struct resident_algorithm *ra = *p;
+		if (ra->area == NULL && !ra->in_use) {
+			*p = ra->next;
+			free(ra);
+		} else
+			p = &ra->next;
+	}
+}
+
+/* Give the working areas of algorithms kept for reuse back to the pool,
+ * returns true if any was freed */
+static bool target_evict_resident_algorithms(struct target *target)
+{
+	bool evicted = false;
+
+	for (struct resident_algorithm *ra = target->resident_algorithms; ra; ra = ra->next) {
+		if (!ra->in_use && ra->area) {
+			LOG_DEBUG("evicting resident algorithm at " TARGET_ADDR_FMT, ra->area->address);
+			/* clears ra->area through the area's user pointer */
+			target_free_working_area(target, ra->area);
+			evicted = true;
+		}
+	}
+
+	target_prune_resident_algorithms(target);
+
+	return evicted;
+}
+
+/* A write overlapping a resident algorithm means it has to be uploaded again */
+static void target_check_resident_algorithms(struct target *target,
+		target_addr_t address, uint32_t size)
+{
+	for (struct resident_algorithm *ra = target->resident_algorithms; ra; ra = ra->next) {
+		if (!ra->in_use && ra->area && address < ra->area->address + ra->area->size
+				&& ra->area->address < address + size)
+			target_free_working_area(target, ra->area);
+	}
+}
+
 int target_alloc_working_area_try(struct target *target, uint32_t size, struct working_area **area)
 {
 	/* Reevaluate working area address based on MMU state*/
@@ -1813,15 +2039,18 @@ int target_alloc_working_area_try(struct target *target, uint32_t size, struct w
 	if (size % 4)
 		size = (size + 3) & (~3UL);
 
-	struct working_area *c = target->working_areas;
+	struct working_area *c = NULL;
 
-	/* Find the first large enough working area */
-	while (c) {
-		if (c->free && c->size >= size)
-			break;
-		c = c->next;
+	/* Find the smallest large enough working area, leaving big ones
+	 * for the buffers that usually follow an algorithm's allocation */
+	for (struct working_area *wa = target->working_areas; wa; wa = wa->next) {
+		if (wa->free && wa->size >= size && (c == NULL || wa->size < c->size))
+			c = wa;
 	}
 
+	if (c == NULL && target_evict_resident_algorithms(target))
+		return target_alloc_working_area_try(target, size, area);
+
 	if (c == NULL)
 		return ERROR_TARGET_RESOURCE_NOT_AVAILABLE;
 
@@ -1978,13 +2207,118 @@ uint32_t target_get_working_area_avail(struct target *target)
 	return max_size;
 }
 
+/* FNV-1a, only used to tell algorithms apart */
+static uint32_t target_algorithm_hash(const uint8_t *code, uint32_t size)
+{
+	uint32_t hash = 2166136261u;
+
+	for (uint32_t i = 0; i < size; i++)
+		hash = (hash ^ code[i]) * 16777619u;
+
+	return hash;
+}
+
+/**
+ * Allocate a working area holding the algorithm @a code.
+ *
+ * Unless the working area has to be backed up, the code stays in place
+ * after target_free_algorithm_working_area(), so the next request for the
+ * same code skips the upload. Resident code is dropped on every resume
+ * and step (only the algorithm being run stays), whenever all working
+ * areas are freed (reset), when memory it occupies is written, on any
+ * physical memory write, and when its space is needed for another
+ * allocation.
+ *
+ * @returns ERROR_OK with @a area pointing at the code, or an error as for
+ * target_alloc_working_area().
+ */
+int target_alloc_algorithm_working_area(struct target *target,
+		const uint8_t *code, uint32_t size, struct working_area **area)
+{
+	uint32_t hash = target_algorithm_hash(code, size);
+	struct resident_algorithm *ra;
+	int retval;
+
+	if (target->backup_working_area) {
+		retval = target_alloc_working_area(target, size, area);
+		if (retval != ERROR_OK)
+			return retval;
+
+		retval = target_write_buffer(target, (*area)->address, size, code);
+		if (retval != ERROR_OK)
+			target_free_working_area(target, *area);
+		return retval;
+	}
+
+	target_prune_resident_algorithms(target);
+
+	for (ra = target->resident_algorithms; ra; ra = ra->next) {
+		if (!ra->in_use && ra->area && ra->hash == hash && ra->size == size) {
+			LOG_DEBUG("reusing resident algorithm at " TARGET_ADDR_FMT, ra->area->address);
+			ra->in_use = true;
+			*area = ra->area;
+			return ERROR_OK;
+		}
+	}
+
+	ra = calloc(1, sizeof(*ra));
+	if (ra == NULL)
+		return ERROR_FAIL;
+
+	/* the entry owns the area, so that freeing all areas invalidates it */
+	retval = target_alloc_working_area(target, size, &ra->area);
+	if (retval != ERROR_OK) {
+		free(ra);
+		return retval;
+	}
+
+	retval = target_write_buffer(target, ra->area->address, size, code);
+	if (retval != ERROR_OK) {
+		target_free_working_area(target, ra->area);
+		free(ra);
+		return retval;
+	}
+
+	ra->hash = hash;
+	ra->size = size;
+	ra->in_use = true;
+	ra->next = target->resident_algorithms;
+	target->resident_algorithms = ra;
+
+	*area = ra->area;
+
+	return ERROR_OK;
+}
+
+/** Release an area from target_alloc_algorithm_working_area(), keeping the code resident */
+int target_free_algorithm_working_area(struct target *target, struct working_area *area)
+{
+	for (struct resident_algorithm *ra = target->resident_algorithms; ra; ra = ra->next) {
+		if (ra->in_use && ra->area == area) {
+			ra->in_use = false;
+			return ERROR_OK;
+		}
+	}
+
+	/* not resident, or already invalidated */
+	for (struct resident_algorithm *ra = target->resident_algorithms; ra; ra = ra->next) {
+		if (ra->in_use && ra->area == NULL) {
+			ra->in_use = false;
+			target_prune_resident_algorithms(target);
+			return ERROR_OK;
+		}
+	}
+
+	return target_free_working_area(target, area);
+}
+
 static void target_destroy(struct target *target)
 {
 	if (target->type->deinit_target)
 		target->type->deinit_target(target);
 
 	if (target->semihosting)
-		free(target->semihosting);
+		semihosting_common_free(target);
 
 	jtag_unregister_event_callback(jtag_enable_callback, target);
 
@@ -1998,6 +2332,12 @@ static void target_destroy(struct target *target)
 
 	target_free_all_working_areas(target);
 
+	while (target->resident_algorithms) {
+		struct resident_algorithm *ra = target->resident_algorithms;
+		target->resident_algorithms = ra->next;
+		free(ra);
+	}
+
 	/* release the targets SMP list */
 	if (target->smp) {
 		struct target_list *head = target->head;
@@ -2028,13 +2368,12 @@ void target_quit(void)
 	}
 	target_event_callbacks = NULL;
 
-	struct target_timer_callback *pt = target_timer_callbacks;
-	while (pt) {
-		struct target_timer_callback *t = pt->next;
-		free(pt);
-		pt = t;
-	}
+	for (unsigned i = 0; i < target_timer_callback_count; i++)
+		free(target_timer_callbacks[i]);
+	free(target_timer_callbacks);
 	target_timer_callbacks = NULL;
+	target_timer_callback_count = 0;
+	target_timer_callback_size = 0;
 
 	for (struct target *target = all_targets; target;) {
 		struct target *tmp;
@@ -2151,7 +2490,17 @@ int target_write_buffer(struct target *target, target_addr_t address, uint32_t s
 		return ERROR_FAIL;
 	}
 
-	return target->type->write_buffer(target, address, size, buffer);
+	if (target->resident_algorithms)
+		target_check_resident_algorithms(target, address, size);
+
+	static struct perf_stat write_stat = PERF_STAT_INIT("target.write");
+	int64_t start = perf_start();
+
+	int retval = target->type->write_buffer(target, address, size, buffer);
+
+	perf_end(&write_stat, start, 1, size, retval);
+
+	return retval;
 }
 
 static int target_write_buffer_default(struct target *target,
@@ -2213,7 +2562,14 @@ int target_read_buffer(struct target *target, target_addr_t address, uint32_t si
 		return ERROR_FAIL;
 	}
 
-	return target->type->read_buffer(target, address, size, buffer);
+	static struct perf_stat read_stat = PERF_STAT_INIT("target.read");
+	int64_t start = perf_start();
+
+	int retval = target->type->read_buffer(target, address, size, buffer);
+
+	perf_end(&read_stat, start, 1, size, retval);
+
+	return retval;
 }
 
 static int target_read_buffer_default(struct target *target, target_addr_t address, uint32_t count, uint8_t *buffer)
@@ -3104,7 +3460,7 @@ COMMAND_HANDLER(handle_step_command)
 
 	struct target *target = get_current_target(CMD_CTX);
 
-	return target->type->step(target, current_pc, addr, 1);
+	return target_step(target, current_pc, addr, 1);
 }
 
 static void handle_md_output(struct command_context *cmd_ctx,
@@ -3370,6 +3726,7 @@ static COMMAND_HELPER(parse_load_image_command_CMD_ARGV, struct image *image,
 COMMAND_HANDLER(handle_load_image_command)
 {
 	uint8_t *buffer;
+	uint8_t *data;
 	size_t buf_cnt;
 	uint32_t image_size;
 	target_addr_t min_address = 0;
@@ -3393,19 +3750,27 @@ COMMAND_HANDLER(handle_load_image_command)
 	image_size = 0x0;
 	retval = ERROR_OK;
 	for (i = 0; i < image.num_sections; i++) {
-		buffer = malloc(image.sections[i].size);
-		if (buffer == NULL) {
-			command_print(CMD_CTX,
-						  "error allocating buffer for section (%d bytes)",
-						  (int)(image.sections[i].size));
-			retval = ERROR_FAIL;
-			break;
-		}
+		buffer = NULL;
 
-		retval = image_read_section(&image, i, 0x0, image.sections[i].size, buffer, &buf_cnt);
-		if (retval != ERROR_OK) {
-			free(buffer);
-			break;
+		/* write straight from the image where it can hand out its content */
+		if (image_get_section_view(&image, i, 0x0, image.sections[i].size, &data) == ERROR_OK) {
+			buf_cnt = image.sections[i].size;
+		} else {
+			buffer = malloc(image.sections[i].size);
+			if (buffer == NULL) {
+				command_print(CMD_CTX,
+							  "error allocating buffer for section (%d bytes)",
+							  (int)(image.sections[i].size));
+				retval = ERROR_FAIL;
+				break;
+			}
+
+			retval = image_read_section(&image, i, 0x0, image.sections[i].size, buffer, &buf_cnt);
+			if (retval != ERROR_OK) {
+				free(buffer);
+				break;
+			}
+			data = buffer;
 		}
 
 		uint32_t offset = 0;
@@ -3426,7 +3791,7 @@ COMMAND_HANDLER(handle_load_image_command)
 				length -= (image.sections[i].base_address + buf_cnt)-max_address;
 
 			retval = target_write_buffer(target,
-					image.sections[i].base_address + offset, length, buffer + offset);
+					image.sections[i].base_address + offset, length, data + offset);
 			if (retval != ERROR_OK) {
 				free(buffer);
 				break;
@@ -4515,6 +4880,320 @@ static int target_array2mem(Jim_Interp *interp, struct target *target,
 	return e;
 }
 
+/* upper limit for a single read_memory/write_memory transfer */
+#define TARGET_TCL_MEMORY_MAX	(64 * 1024 * 1024)
+/* data is moved to and from the target in pieces of this size */
+#define TARGET_TCL_MEMORY_CHUNK	(64 * 1024)
+
+static int target_tcl_parse_phys(Jim_Interp *interp, int argc,
+		Jim_Obj *const *argv, int nargs, const char *usage, bool *is_phys)
+{
+	if (argc != nargs && argc != nargs + 1) {
+		Jim_WrongNumArgs(interp, 0, argv, usage);
+		return JIM_ERR;
+	}
+
+	*is_phys = false;
+	if (argc > nargs) {
+		if (strcmp(Jim_GetString(argv[nargs], NULL), "phys") != 0) {
+			Jim_SetResultFormatted(interp, "expected 'phys', got '%#s'", argv[nargs]);
+			return JIM_ERR;
+		}
+		*is_phys = true;
+	}
+
+	return JIM_OK;
+}
+
+static int target_tcl_parse_width(Jim_Interp *interp, Jim_Obj *obj,
+		target_addr_t address, unsigned int *width)
+{
+	long l;
+
+	if (Jim_GetLong(interp, obj, &l) != JIM_OK)
+		return JIM_ERR;
+
+	if (l != 8 && l != 16 && l != 32 && l != 64) {
+		Jim_SetResultString(interp, "Invalid width param, must be 8/16/32/64", -1);
+		return JIM_ERR;
+	}
+
+	*width = l / 8;
+	if (address & (*width - 1)) {
+		Jim_SetResultFormatted(interp, "address 0x%" PRIx64 " is not aligned for %ld bit access",
+				(uint64_t)address, l);
+		return JIM_ERR;
+	}
+
+	return JIM_OK;
+}
+
+/* Move @a size bytes between @a buffer and the target, using accesses of
+ * @a width bytes (64 bit items are moved as pairs of words). */
+static int target_tcl_transfer(struct target *target, target_addr_t address,
+		unsigned int width, uint32_t size, uint8_t *buffer, bool is_phys, bool write)
+{
+	unsigned int access = MIN(width, 4u);
+
+	while (size > 0) {
+		uint32_t chunk = MIN(size, (uint32_t)TARGET_TCL_MEMORY_CHUNK);
+		int retval;
+
+		if (write && is_phys)
+			retval = target_write_phys_memory(target, address, access, chunk / access, buffer);
+		else if (write)
+			retval = target_write_memory(target, address, access, chunk / access, buffer);
+		else if (is_phys)
+			retval = target_read_phys_memory(target, address, access, chunk / access, buffer);
+		else
+			retval = target_read_memory(target, address, access, chunk / access, buffer);
+		if (retval != ERROR_OK)
+			return retval;
+
+		address += chunk;
+		buffer += chunk;
+		size -= chunk;
+	}
+
+	return ERROR_OK;
+}
+
+static int target_read_memory_list(Jim_Interp *interp, struct target *target,
+		int argc, Jim_Obj *const *argv)
+{
+	jim_wide address, count;
+	unsigned int width;
+	bool is_phys;
+
+	if (target_tcl_parse_phys(interp, argc, argv, 3, "address width count ['phys']",
+			&is_phys) != JIM_OK)
+		return JIM_ERR;
+
+	if (Jim_GetWide(interp, argv[0], &address) != JIM_OK ||
+			target_tcl_parse_width(interp, argv[1], address, &width) != JIM_OK ||
+			Jim_GetWide(interp, argv[2], &count) != JIM_OK)
+		return JIM_ERR;
+
+	if (count <= 0 || count > TARGET_TCL_MEMORY_MAX / width) {
+		Jim_SetResultFormatted(interp, "read_memory: invalid count %#s", argv[2]);
+		return JIM_ERR;
+	}
+
+	uint8_t *buffer = malloc(count * width);
+	Jim_Obj **objv = malloc(count * sizeof(*objv));
+	if (buffer == NULL || objv == NULL) {
+		free(buffer);
+		free(objv);
+		Jim_SetResultString(interp, "read_memory: out of memory", -1);
+		return JIM_ERR;
+	}
+
+	int retval = target_tcl_transfer(target, address, width, count * width,
+			buffer, is_phys, false);
+	if (retval != ERROR_OK) {
+		free(buffer);
+		free(objv);
+		Jim_SetResultFormatted(interp, "read_memory: cannot read memory at 0x%" PRIx64,
+				(uint64_t)address);
+		return JIM_ERR;
+	}
+
+	for (jim_wide i = 0; i < count; i++) {
+		const uint8_t *p = buffer + i * width;
+		uint64_t v;
+
+		switch (width) {
+		case 8:
+			v = target_buffer_get_u64(target, p);
+			break;
+		case 4:
+			v = target_buffer_get_u32(target, p);
+			break;
+		case 2:
+			v = target_buffer_get_u16(target, p);
+			break;
+		default:
+			v = *p;
+			break;
+		}
+		objv[i] = Jim_NewIntObj(interp, v);
+	}
+
+	Jim_SetResult(interp, Jim_NewListObj(interp, objv, count));
+
+	free(objv);
+	free(buffer);
+	return JIM_OK;
+}
+
+static int target_write_memory_list(Jim_Interp *interp, struct target *target,
+		int argc, Jim_Obj *const *argv)
+{
+	jim_wide address;
+	unsigned int width;
+	bool is_phys;
+
+	if (target_tcl_parse_phys(interp, argc, argv, 3, "address width data ['phys']",
+			&is_phys) != JIM_OK)
+		return JIM_ERR;
+
+	if (Jim_GetWide(interp, argv[0], &address) != JIM_OK ||
+			target_tcl_parse_width(interp, argv[1], address, &width) != JIM_OK)
+		return JIM_ERR;
+
+	int count = Jim_ListLength(interp, argv[2]);
+	if (count == 0) {
+		Jim_SetResult(interp, Jim_NewEmptyStringObj(interp));
+		return JIM_OK;
+	}
+	if ((jim_wide)count > TARGET_TCL_MEMORY_MAX / width) {
+		Jim_SetResultString(interp, "write_memory: too much data", -1);
+		return JIM_ERR;
+	}
+
+	uint8_t *buffer = malloc(count * width);
+	if (buffer == NULL) {
+		Jim_SetResultString(interp, "write_memory: out of memory", -1);
+		return JIM_ERR;
+	}
+
+	for (int i = 0; i < count; i++) {
+		uint8_t *p = buffer + i * width;
+		jim_wide v;
+
+		if (Jim_GetWide(interp, Jim_ListGetIndex(interp, argv[2], i), &v) != JIM_OK) {
+			free(buffer);
+			return JIM_ERR;
+		}
+
+		switch (width) {
+		case 8:
+			target_buffer_set_u64(target, p, v);
+			break;
+		case 4:
+			target_buffer_set_u32(target, p, v);
+			break;
+		case 2:
+			target_buffer_set_u16(target, p, v);
+			break;
+		default:
+			*p = v;
+			break;
+		}
+	}
+
+	int retval = target_tcl_transfer(target, address, width, count * width,
+			buffer, is_phys, true);
+	free(buffer);
+	if (retval != ERROR_OK) {
+		Jim_SetResultFormatted(interp, "write_memory: cannot write memory at 0x%" PRIx64,
+				(uint64_t)address);
+		return JIM_ERR;
+	}
+
+	Jim_SetResult(interp, Jim_NewEmptyStringObj(interp));
+	return JIM_OK;
+}
+
+static int target_read_memory_binary(Jim_Interp *interp, struct target *target,
+		int argc, Jim_Obj *const *argv)
+{
+	jim_wide address, count;
+	bool is_phys;
+
+	if (target_tcl_parse_phys(interp, argc, argv, 2, "address count ['phys']",
+			&is_phys) != JIM_OK)
+		return JIM_ERR;
+
+	if (Jim_GetWide(interp, argv[0], &address) != JIM_OK ||
+			Jim_GetWide(interp, argv[1], &count) != JIM_OK)
+		return JIM_ERR;
+
+	if (count <= 0 || count > TARGET_TCL_MEMORY_MAX) {
+		Jim_SetResultFormatted(interp, "read_binary: invalid count %#s", argv[1]);
+		return JIM_ERR;
+	}
+
+	/* Jim takes over the buffer, it needs room for a terminating NUL */
+	char *buffer = Jim_Alloc(count + 1);
+	if (buffer == NULL) {
+		Jim_SetResultString(interp, "read_binary: out of memory", -1);
+		return JIM_ERR;
+	}
+	int retval = target_tcl_transfer(target, address, 1, count,
+			(uint8_t *)buffer, is_phys, false);
+	if (retval != ERROR_OK) {
+		Jim_Free(buffer);
+		Jim_SetResultFormatted(interp, "read_binary: cannot read memory at 0x%" PRIx64,
+				(uint64_t)address);
+		return JIM_ERR;
+	}
+	buffer[count] = '\0';
+
+	Jim_SetResult(interp, Jim_NewStringObjNoAlloc(interp, buffer, count));
+	return JIM_OK;
+}
+
+static int target_write_memory_binary(Jim_Interp *interp, struct target *target,
+		int argc, Jim_Obj *const *argv)
+{
+	jim_wide address;
+	bool is_phys;
+	int len;
+
+	if (target_tcl_parse_phys(interp, argc, argv, 2, "address data ['phys']",
+			&is_phys) != JIM_OK)
+		return JIM_ERR;
+
+	if (Jim_GetWide(interp, argv[0], &address) != JIM_OK)
+		return JIM_ERR;
+
+	/* the string representation is written as is, no copy needed */
+	const char *data = Jim_GetString(argv[1], &len);
+	int retval = target_tcl_transfer(target, address, 1, len,
+			(uint8_t *)data, is_phys, true);
+	if (retval != ERROR_OK) {
+		Jim_SetResultFormatted(interp, "write_binary: cannot write memory at 0x%" PRIx64,
+				(uint64_t)address);
+		return JIM_ERR;
+	}
+
+	Jim_SetResult(interp, Jim_NewEmptyStringObj(interp));
+	return JIM_OK;
+}
+
+static int jim_read_memory(Jim_Interp *interp, int argc, Jim_Obj *const *argv)
+{
+	struct command_context *context = current_command_context(interp);
+	struct target *target = get_current_target(context);
+
+	return target_read_memory_list(interp, target, argc - 1, argv + 1);
+}
+
+static int jim_write_memory(Jim_Interp *interp, int argc, Jim_Obj *const *argv)
+{
+	struct command_context *context = current_command_context(interp);
+	struct target *target = get_current_target(context);
+
+	return target_write_memory_list(interp, target, argc - 1, argv + 1);
+}
+
+static int jim_read_binary(Jim_Interp *interp, int argc, Jim_Obj *const *argv)
+{
+	struct command_context *context = current_command_context(interp);
+	struct target *target = get_current_target(context);
+
+	return target_read_memory_binary(interp, target, argc - 1, argv + 1);
+}
+
+static int jim_write_binary(Jim_Interp *interp, int argc, Jim_Obj *const *argv)
+{
+	struct command_context *context = current_command_context(interp);
+	struct target *target = get_current_target(context);
+
+	return target_write_memory_binary(interp, target, argc - 1, argv + 1);
+}
+
 /* FIX? should we propagate errors here rather than printing them
  * and continuing?
  */
@@ -5154,6 +5833,34 @@ static int jim_target_array2mem(Jim_Interp *interp,
 	return target_array2mem(interp, target, argc - 1, argv + 1);
 }
 
+static int jim_target_read_memory(Jim_Interp *interp,
+		int argc, Jim_Obj *const *argv)
+{
+	struct target *target = Jim_CmdPrivData(interp);
+	return target_read_memory_list(interp, target, argc - 1, argv + 1);
+}
+
+static int jim_target_write_memory(Jim_Interp *interp,
+		int argc, Jim_Obj *const *argv)
+{
+	struct target *target = Jim_CmdPrivData(interp);
+	return target_write_memory_list(interp, target, argc - 1, argv + 1);
+}
+
+static int jim_target_read_binary(Jim_Interp *interp,
+		int argc, Jim_Obj *const *argv)
+{
+	struct target *target = Jim_CmdPrivData(interp);
+	return target_read_memory_binary(interp, target, argc - 1, argv + 1);
+}
+
+static int jim_target_write_binary(Jim_Interp *interp,
+		int argc, Jim_Obj *const *argv)
+{
+	struct target *target = Jim_CmdPrivData(interp);
+	return target_write_memory_binary(interp, target, argc - 1, argv + 1);
+}
+
 static int jim_target_tap_disabled(Jim_Interp *interp)
 {
 	Jim_SetResultFormatted(interp, "[TAP is disabled]");
@@ -5478,6 +6185,36 @@ static const struct command_registration target_instance_command_handlers[] = {
 			"from target memory",
 		.usage = "arrayname bitwidth address count",
 	},
+	{
+		.name = "read_memory",
+		.mode = COMMAND_EXEC,
+		.jim_handler = jim_target_read_memory,
+		.help = "Returns a list of 8/16/32/64 bit numbers "
+			"read from target memory",
+		.usage = "address width count ['phys']",
+	},
+	{
+		.name = "write_memory",
+		.mode = COMMAND_EXEC,
+		.jim_handler = jim_target_write_memory,
+		.help = "Writes a list of 8/16/32/64 bit numbers "
+			"to target memory",
+		.usage = "address width data ['phys']",
+	},
+	{
+		.name = "read_binary",
+		.mode = COMMAND_EXEC,
+		.jim_handler = jim_target_read_binary,
+		.help = "Returns target memory as a binary string",
+		.usage = "address count ['phys']",
+	},
+	{
+		.name = "write_binary",
+		.mode = COMMAND_EXEC,
+		.jim_handler = jim_target_write_binary,
+		.help = "Writes a binary string to target memory",
+		.usage = "address data ['phys']",
+	},
 	{
 		.name = "eventlist",
 		.mode = COMMAND_EXEC,
@@ -6073,7 +6810,82 @@ COMMAND_HANDLER(handle_fast_load_command)
 	return retval;
 }
 
+COMMAND_HANDLER(handle_adaptive_poll_command)
+{
+	if (CMD_ARGC != 0 && CMD_ARGC != 2)
+		return ERROR_COMMAND_SYNTAX_ERROR;
+
+	if (CMD_ARGC == 2) {
+		int min_ms, max_ms;
+
+		COMMAND_PARSE_NUMBER(int, CMD_ARGV[0], min_ms);
+		COMMAND_PARSE_NUMBER(int, CMD_ARGV[1], max_ms);
+		if (min_ms < 0 || max_ms < 1 || min_ms > max_ms)
+			return ERROR_COMMAND_ARGUMENT_INVALID;
+
+		adaptive_poll_min_ms = min_ms;
+		adaptive_poll_max_ms = max_ms;
+	}
+
+	command_print(CMD_CTX, "adaptive polling interval: %d to %d ms",
+		adaptive_poll_min_ms, adaptive_poll_max_ms);
+
+	return ERROR_OK;
+}
+
+COMMAND_HANDLER(handle_perf_timers_command)
+{
+	if (CMD_ARGC != 0)
+		return ERROR_COMMAND_SYNTAX_ERROR;
+
+	int64_t now = monotonic_us();
+
+	for (unsigned i = 0; i < target_timer_callback_count; i++) {
+		struct target_timer_callback *cb = target_timer_callbacks[i];
+		char name[32];
+
+		if (cb->callback == handle_target)
+			snprintf(name, sizeof(name), "target poll");
+		else
+			snprintf(name, sizeof(name), "%p", cb->callback);
+
+		command_print(CMD_CTX, "%-18s %s %6d ms, due in %7" PRId64 " us, %8" PRIu64 " calls, "
+				"total %10" PRId64 " us, max %8" PRId64 " us",
+				name, cb->periodic ? "every" : "after", cb->time_ms,
+				cb->when - now, cb->calls, cb->total_us, cb->max_us);
+	}
+
+	return ERROR_OK;
+}
+
+static const struct command_registration target_perf_subcommand_handlers[] = {
+	{
+		.name = "timers",
+		.handler = handle_perf_timers_command,
+		.mode = COMMAND_ANY,
+		.help = "list timer callbacks with their deadlines and run time",
+		.usage = "",
+	},
+	COMMAND_REGISTRATION_DONE
+};
+
 static const struct command_registration target_command_handlers[] = {
+	{
+		.name = "perf",
+		.mode = COMMAND_ANY,
+		.help = "performance statistics of the JTAG, DAP, target, flash "
+			"and GDB layers",
+		.usage = "",
+		.chain = target_perf_subcommand_handlers,
+	},
+	{
+		.name = "adaptive_poll",
+		.handler = handle_adaptive_poll_command,
+		.mode = COMMAND_ANY,
+		.help = "display or set the polling interval range of DCC, "
+			"trace and RTT channels",
+		.usage = "[min_ms max_ms]",
+	},
 	{
 		.name = "targets",
 		.handler = handle_targets_command,
@@ -6548,6 +7360,34 @@ static const struct command_registration target_exec_command_handlers[] = {
 			"and write the 8/16/32 bit values",
 		.usage = "arrayname bitwidth address count",
 	},
+	{
+		.name = "read_memory",
+		.mode = COMMAND_EXEC,
+		.jim_handler = jim_read_memory,
+		.help = "read 8/16/32/64 bit memory and return as a TCL list",
+		.usage = "address width count ['phys']",
+	},
+	{
+		.name = "write_memory",
+		.mode = COMMAND_EXEC,
+		.jim_handler = jim_write_memory,
+		.help = "write a TCL list of 8/16/32/64 bit values to memory",
+		.usage = "address width data ['phys']",
+	},
+	{
+		.name = "read_binary",
+		.mode = COMMAND_EXEC,
+		.jim_handler = jim_read_binary,
+		.help = "read memory and return it as a binary string",
+		.usage = "address count ['phys']",
+	},
+	{
+		.name = "write_binary",
+		.mode = COMMAND_EXEC,
+		.jim_handler = jim_write_binary,
+		.help = "write a binary string to memory",
+		.usage = "address data ['phys']",
+	},
 	{
 		.name = "reset_nag",
 		.handler = handle_target_reset_nag,
@@ -101,6 +101,17 @@ struct working_area {
 	struct working_area *next;
 };
 
+/* algorithm code kept in the working area between uses,
+ * see target_alloc_algorithm_working_area() */
+struct resident_algorithm {
+	uint32_t hash;
+	uint32_t size;
+	bool in_use;
+	/* NULLed by target_free_all_working_areas(), e.g. on resume or reset */
+	struct working_area *area;
+	struct resident_algorithm *next;
+};
+
 struct gdb_service {
 	struct target *target;
 	/*  field for smp display  */
@@ -162,6 +173,7 @@ struct target {
 	uint32_t working_area_size;			/* size in bytes */
 	uint32_t backup_working_area;		/* whether the content of the working area has to be preserved */
 	struct working_area *working_areas;/* list of allocated working areas */
+	struct resident_algorithm *resident_algorithms; /* algorithms cached in working areas */
 	enum target_debug_reason debug_reason;/* reason why the target entered debug state */
 	enum target_endianness endianness;	/* target endianness */
 	/* also see: target_state_name() */
@@ -319,9 +331,20 @@ struct target_timer_callback {
 	int time_ms;
 	int periodic;
 	bool removed;
-	struct timeval when;
+	int64_t when;		/* monotonic_us() deadline */
 	void *priv;
-	struct target_timer_callback *next;
+	unsigned heap_index;	/* position in the deadline heap */
+	uint64_t pass;		/* last target_call_timer_callbacks() run that called it */
+
+	/* interval adapted to the traffic, see target_register_adaptive_timer_callback() */
+	bool adaptive;
+	bool active;
+	int max_ms;
+
+	/* runtime accounting, see "perf timers" */
+	uint64_t calls;
+	int64_t total_us;
+	int64_t max_us;
 };
 
 struct target_memory_check_block {
@@ -387,7 +410,25 @@ int target_call_trace_callbacks(struct target *target, size_t len, uint8_t *data
 int target_register_timer_callback(int (*callback)(void *priv),
 		int time_ms, int periodic, void *priv);
 int target_unregister_timer_callback(int (*callback)(void *priv), void *priv);
+
+/**
+ * Register a periodic callback polling a data channel (DCC, trace, RTT)
+ * whose interval follows the traffic: it polls at the "adaptive_poll"
+ * minimum interval while the callback reports data with
+ * target_timer_callback_active(), and backs off exponentially up to
+ * @a max_ms (the "adaptive_poll" maximum if 0) while it does not.
+ * Unregister with target_unregister_timer_callback().
+ */
+int target_register_adaptive_timer_callback(int (*callback)(void *priv),
+		int max_ms, void *priv);
+/** Called from a running timer callback when it found data to process */
+void target_timer_callback_active(void);
 int target_call_timer_callbacks(void);
+/**
+ * @returns the monotonic_us() time at which the next timer callback is
+ * due, or INT64_MAX when there is none.
+ */
+int64_t target_timer_next_event(void);
 /**
  * Invoke this to ensure that e.g. polling timer callbacks happen before
  * a synchronous command completes.
@@ -670,6 +711,9 @@ int target_alloc_working_area_try(struct target *target,
 		uint32_t size, struct working_area **area);
 int target_free_working_area(struct target *target, struct working_area *area);
 void target_free_all_working_areas(struct target *target);
+int target_alloc_algorithm_working_area(struct target *target,
+		const uint8_t *code, uint32_t size, struct working_area **area);
+int target_free_algorithm_working_area(struct target *target, struct working_area *area);
 uint32_t target_get_working_area_avail(struct target *target);
 
 /**
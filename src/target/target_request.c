@@ -124,6 +124,7 @@ int target_request(struct target *target, uint32_t request)
 
 	/* Record that we got a target message for back-off algorithm */
 	got_message = true;
+	target_timer_callback_active();
 
 	if (charmsg_mode) {
 		target_charmsg(target, target_req_cmd);
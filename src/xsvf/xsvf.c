@@ -41,6 +41,7 @@
 #include "xsvf.h"
 #include <jtag/jtag.h>
 #include <svf/svf.h>
+#include <helper/fileio.h>
 
 /* XSVF commands, from appendix B of xapp503.pdf  */
 #define XCOMPLETE			0x00
@@ -119,7 +120,70 @@ TDO  (1);
 
 #define XSTATE_MAX_PATH 12
 
-static int xsvf_fd;
+/* The whole XSVF file is read into memory up front: it is already a
+ * compact binary command stream, and this replaces a read() system
+ * call for every single byte of every vector. */
+static uint8_t *xsvf_data;
+static size_t xsvf_size;
+static size_t xsvf_pos;
+
+static int xsvf_load(const char *filename)
+{
+	struct fileio *fileio;
+	size_t size, read_bytes;
+
+	free(xsvf_data);
+	xsvf_data = NULL;
+	xsvf_size = 0;
+	xsvf_pos = 0;
+
+	if (fileio_open(&fileio, filename, FILEIO_READ, FILEIO_BINARY) != ERROR_OK)
+		return ERROR_FAIL;
+
+	int retval = fileio_size(fileio, &size);
+	if (retval == ERROR_OK) {
+		xsvf_data = malloc(size ? size : 1);
+		if (!xsvf_data) {
+			LOG_ERROR("not enough memory");
+			retval = ERROR_FAIL;
+		}
+	}
+	if (retval == ERROR_OK)
+		retval = fileio_read(fileio, size, xsvf_data, &read_bytes);
+	if (retval == ERROR_OK && read_bytes != size)
+		retval = ERROR_FAIL;
+
+	fileio_close(fileio);
+
+	if (retval != ERROR_OK) {
+		free(xsvf_data);
+		xsvf_data = NULL;
+		return retval;
+	}
+
+	xsvf_size = size;
+	return ERROR_OK;
+}
+
+static void xsvf_unload(void)
+{
+	free(xsvf_data);
+	xsvf_data = NULL;
+	xsvf_size = 0;
+	xsvf_pos = 0;
+}
+
+/* like read() on the file used to be, but fails at the end of file */
+static int xsvf_read(void *buf, size_t count)
+{
+	if (xsvf_size - xsvf_pos < count)
+		return -1;
+
+	memcpy(buf, xsvf_data + xsvf_pos, count);
+	xsvf_pos += count;
+
+	return count;
+}
 
 /* map xsvf tap state to an openocd "tap_state_t" */
 static tap_state_t xsvf_to_tap(int xsvf_state)
@@ -183,15 +247,18 @@ static tap_state_t xsvf_to_tap(int xsvf_state)
 	return ret;
 }
 
-static int xsvf_read_buffer(int num_bits, int fd, uint8_t *buf)
+static int xsvf_read_buffer(int num_bits, uint8_t *buf)
 {
-	int num_bytes;
+	size_t num_bytes = (num_bits + 7) / 8;
 
-	for (num_bytes = (num_bits + 7) / 8; num_bytes > 0; num_bytes--) {
-		/* reverse the order of bytes as they are read sequentially from file */
-		if (read(fd, buf + num_bytes - 1, 1) < 0)
-			return ERROR_XSVF_EOF;
-	}
+	if (xsvf_size - xsvf_pos < num_bytes)
+		return ERROR_XSVF_EOF;
+
+	/* reverse the order of bytes as they are stored sequentially in the file */
+	const uint8_t *src = xsvf_data + xsvf_pos;
+	for (size_t i = 0; i < num_bytes; i++)
+		buf[num_bytes - 1 - i] = src[i];
+	xsvf_pos += num_bytes;
 
 	return ERROR_OK;
 }
@@ -254,8 +321,7 @@ COMMAND_HANDLER(handle_xsvf_command)
 		}
 	}
 
-	xsvf_fd = open(filename, O_RDONLY);
-	if (xsvf_fd < 0) {
+	if (xsvf_load(filename) != ERROR_OK) {
 		command_print(CMD_CTX, "file \"%s\" not found", filename);
 		return ERROR_FAIL;
 	}
@@ -274,9 +340,9 @@ COMMAND_HANDLER(handle_xsvf_command)
 	LOG_WARNING("XSVF support in OpenOCD is limited. Consider using SVF instead");
 	LOG_USER("xsvf processing file: \"%s\"", filename);
 
-	while (read(xsvf_fd, &opcode, 1) > 0) {
+	while (xsvf_read(&opcode, 1) > 0) {
 		/* record the position of this opcode within the file */
-		file_offset = lseek(xsvf_fd, 0, SEEK_CUR) - 1;
+		file_offset = xsvf_pos - 1;
 
 		/* maybe collect another state for a pathmove();
 		 * or terminate a path.
@@ -296,7 +362,7 @@ COMMAND_HANDLER(handle_xsvf_command)
 						break;
 					}
 
-					if (read(xsvf_fd, &uc, 1) < 0) {
+					if (xsvf_read(&uc, 1) < 0) {
 						do_abort = 1;
 						break;
 					}
@@ -368,7 +434,7 @@ COMMAND_HANDLER(handle_xsvf_command)
 			case XTDOMASK:
 				LOG_DEBUG("XTDOMASK");
 				if (dr_in_mask &&
-						(xsvf_read_buffer(xsdrsize, xsvf_fd, dr_in_mask) != ERROR_OK))
+						(xsvf_read_buffer(xsdrsize, dr_in_mask) != ERROR_OK))
 					do_abort = 1;
 				break;
 
@@ -376,7 +442,7 @@ COMMAND_HANDLER(handle_xsvf_command)
 			{
 				uint8_t xruntest_buf[4];
 
-				if (read(xsvf_fd, xruntest_buf, 4) < 0) {
+				if (xsvf_read(xruntest_buf, 4) < 0) {
 					do_abort = 1;
 					break;
 				}
@@ -390,7 +456,7 @@ COMMAND_HANDLER(handle_xsvf_command)
 			{
 				uint8_t myrepeat;
 
-				if (read(xsvf_fd, &myrepeat, 1) < 0)
+				if (xsvf_read(&myrepeat, 1) < 0)
 					do_abort = 1;
 				else {
 					xrepeat = myrepeat;
@@ -403,7 +469,7 @@ COMMAND_HANDLER(handle_xsvf_command)
 			{
 				uint8_t xsdrsize_buf[4];
 
-				if (read(xsvf_fd, xsdrsize_buf, 4) < 0) {
+				if (xsvf_read(xsdrsize_buf, 4) < 0) {
 					do_abort = 1;
 					break;
 				}
@@ -433,14 +499,13 @@ COMMAND_HANDLER(handle_xsvf_command)
 
 				const char *op_name = (opcode == XSDR ? "XSDR" : "XSDRTDO");
 
-				if (xsvf_read_buffer(xsdrsize, xsvf_fd, dr_out_buf) != ERROR_OK) {
+				if (xsvf_read_buffer(xsdrsize, dr_out_buf) != ERROR_OK) {
 					do_abort = 1;
 					break;
 				}
 
 				if (opcode == XSDRTDO) {
-					if (xsvf_read_buffer(xsdrsize, xsvf_fd,
-						dr_in_buf)  != ERROR_OK) {
+					if (xsvf_read_buffer(xsdrsize, dr_in_buf)  != ERROR_OK) {
 						do_abort = 1;
 						break;
 					}
@@ -519,7 +584,7 @@ COMMAND_HANDLER(handle_xsvf_command)
 				if (xruntest) {
 					result = svf_add_statemove(TAP_IDLE);
 					if (result != ERROR_OK)
-						return result;
+						goto out;
 
 					if (runtest_requires_tck)
 						jtag_add_clocks(xruntest);
@@ -529,7 +594,7 @@ COMMAND_HANDLER(handle_xsvf_command)
 					/* we are already in TAP_DRPAUSE */
 					result = svf_add_statemove(xenddr);
 					if (result != ERROR_OK)
-						return result;
+						goto out;
 				}
 			}
 			break;
@@ -578,7 +643,7 @@ COMMAND_HANDLER(handle_xsvf_command)
 			{
 				tap_state_t mystate;
 
-				if (read(xsvf_fd, &uc, 1) < 0) {
+				if (xsvf_read(&uc, 1) < 0) {
 					do_abort = 1;
 					break;
 				}
@@ -621,7 +686,7 @@ COMMAND_HANDLER(handle_xsvf_command)
 
 			case XENDIR:
 
-				if (read(xsvf_fd, &uc, 1) < 0) {
+				if (xsvf_read(&uc, 1) < 0) {
 					do_abort = 1;
 					break;
 				}
@@ -642,7 +707,7 @@ COMMAND_HANDLER(handle_xsvf_command)
 
 			case XENDDR:
 
-				if (read(xsvf_fd, &uc, 1) < 0) {
+				if (xsvf_read(&uc, 1) < 0) {
 					do_abort = 1;
 					break;
 				}
@@ -671,14 +736,14 @@ COMMAND_HANDLER(handle_xsvf_command)
 
 				if (opcode == XSIR) {
 					/* one byte bitcount */
-					if (read(xsvf_fd, short_buf, 1) < 0) {
+					if (xsvf_read(short_buf, 1) < 0) {
 						do_abort = 1;
 						break;
 					}
 					bitcount = short_buf[0];
 					LOG_DEBUG("XSIR %d", bitcount);
 				} else {
-					if (read(xsvf_fd, short_buf, 2) < 0) {
+					if (xsvf_read(short_buf, 2) < 0) {
 						do_abort = 1;
 						break;
 					}
@@ -688,7 +753,7 @@ COMMAND_HANDLER(handle_xsvf_command)
 
 				ir_buf = malloc((bitcount + 7) / 8);
 
-				if (xsvf_read_buffer(bitcount, xsvf_fd, ir_buf) != ERROR_OK)
+				if (xsvf_read_buffer(bitcount, ir_buf) != ERROR_OK)
 					do_abort = 1;
 				else {
 					struct scan_field field;
@@ -731,7 +796,7 @@ COMMAND_HANDLER(handle_xsvf_command)
 				char comment[128];
 
 				do {
-					if (read(xsvf_fd, &uc, 1) < 0) {
+					if (xsvf_read(&uc, 1) < 0) {
 						do_abort = 1;
 						break;
 					}
@@ -761,9 +826,9 @@ COMMAND_HANDLER(handle_xsvf_command)
 				tap_state_t end_state;
 				int delay;
 
-				if (read(xsvf_fd, &wait_local, 1) < 0
-					|| read(xsvf_fd, &end, 1) < 0
-					|| read(xsvf_fd, delay_buf, 4) < 0) {
+				if (xsvf_read(&wait_local, 1) < 0
+					|| xsvf_read(&end, 1) < 0
+					|| xsvf_read(delay_buf, 4) < 0) {
 						do_abort = 1;
 						break;
 				}
@@ -781,11 +846,11 @@ COMMAND_HANDLER(handle_xsvf_command)
 					/* FIXME handle statemove errors ... */
 					result = svf_add_statemove(wait_state);
 					if (result != ERROR_OK)
-						return result;
+						goto out;
 					jtag_add_sleep(delay);
 					result = svf_add_statemove(end_state);
 					if (result != ERROR_OK)
-						return result;
+						goto out;
 				}
 			}
 			break;
@@ -806,10 +871,10 @@ COMMAND_HANDLER(handle_xsvf_command)
 				int clock_count;
 				int usecs;
 
-				if (read(xsvf_fd, &wait_local, 1) < 0
-						||  read(xsvf_fd, &end, 1) < 0
-						||  read(xsvf_fd, clock_buf, 4) < 0
-						||  read(xsvf_fd, usecs_buf, 4) < 0) {
+				if (xsvf_read(&wait_local, 1) < 0
+						||  xsvf_read(&end, 1) < 0
+						||  xsvf_read(clock_buf, 4) < 0
+						||  xsvf_read(usecs_buf, 4) < 0) {
 					do_abort = 1;
 					break;
 				}
@@ -840,14 +905,14 @@ COMMAND_HANDLER(handle_xsvf_command)
 				/* FIXME handle statemove errors ... */
 				result = svf_add_statemove(wait_state);
 				if (result != ERROR_OK)
-					return result;
+					goto out;
 
 				jtag_add_clocks(clock_count);
 				jtag_add_sleep(usecs);
 
 				result = svf_add_statemove(end_state);
 				if (result != ERROR_OK)
-					return result;
+					goto out;
 			}
 			break;
 
@@ -858,7 +923,7 @@ COMMAND_HANDLER(handle_xsvf_command)
 				*/
 				uint8_t count_buf[4];
 
-				if (read(xsvf_fd, count_buf, 4) < 0) {
+				if (xsvf_read(count_buf, 4) < 0) {
 					do_abort = 1;
 					break;
 				}
@@ -877,9 +942,9 @@ COMMAND_HANDLER(handle_xsvf_command)
 				uint8_t clock_buf[4];
 				uint8_t usecs_buf[4];
 
-				if (read(xsvf_fd, &state, 1) < 0
-						|| read(xsvf_fd, clock_buf, 4) < 0
-						|| read(xsvf_fd, usecs_buf, 4) < 0) {
+				if (xsvf_read(&state, 1) < 0
+						|| xsvf_read(clock_buf, 4) < 0
+						|| xsvf_read(usecs_buf, 4) < 0) {
 					do_abort = 1;
 					break;
 				}
@@ -905,8 +970,8 @@ COMMAND_HANDLER(handle_xsvf_command)
 
 				LOG_DEBUG("LSDR");
 
-				if (xsvf_read_buffer(xsdrsize, xsvf_fd, dr_out_buf) != ERROR_OK
-						|| xsvf_read_buffer(xsdrsize, xsvf_fd, dr_in_buf) != ERROR_OK) {
+				if (xsvf_read_buffer(xsdrsize, dr_out_buf) != ERROR_OK
+						|| xsvf_read_buffer(xsdrsize, dr_in_buf) != ERROR_OK) {
 					do_abort = 1;
 					break;
 				}
@@ -919,7 +984,7 @@ COMMAND_HANDLER(handle_xsvf_command)
 
 					result = svf_add_statemove(loop_state);
 					if (result != ERROR_OK)
-						return result;
+						goto out;
 					jtag_add_clocks(loop_clocks);
 					jtag_add_sleep(loop_usecs);
 
@@ -963,7 +1028,7 @@ COMMAND_HANDLER(handle_xsvf_command)
 			{
 				uint8_t trst_mode;
 
-				if (read(xsvf_fd, &trst_mode, 1) < 0) {
+				if (xsvf_read(&trst_mode, 1) < 0) {
 					do_abort = 1;
 					break;
 				}
@@ -996,35 +1061,33 @@ COMMAND_HANDLER(handle_xsvf_command)
 			/* upon error, return the TAPs to a reasonable state */
 			result = svf_add_statemove(TAP_IDLE);
 			if (result != ERROR_OK)
-				return result;
+				goto out;
 			result = jtag_execute_queue();
 			if (result != ERROR_OK)
-				return result;
+				goto out;
 			break;
 		}
 	}
 
+	result = ERROR_FAIL;
+
 	if (tdo_mismatch) {
 		command_print(CMD_CTX,
 			"TDO mismatch, somewhere near offset %lu in xsvf file, aborting",
 			file_offset);
-
-		return ERROR_FAIL;
-	}
-
-	if (unsupported) {
-		off_t offset = lseek(xsvf_fd, 0, SEEK_CUR) - 1;
+	} else if (unsupported) {
+		off_t offset = xsvf_pos - 1;
 		command_print(CMD_CTX,
 			"unsupported xsvf command (0x%02X) at offset %jd, aborting",
 			uc, (intmax_t)offset);
-		return ERROR_FAIL;
-	}
-
-	if (do_abort) {
+	} else if (do_abort) {
 		command_print(CMD_CTX, "premature end of xsvf file detected, aborting");
-		return ERROR_FAIL;
+	} else {
+		command_print(CMD_CTX, "XSVF file programmed successfully");
+		result = ERROR_OK;
 	}
 
+out:
 	if (dr_out_buf)
 		free(dr_out_buf);
 
@@ -1034,11 +1097,9 @@ COMMAND_HANDLER(handle_xsvf_command)
 	if (dr_in_mask)
 		free(dr_in_mask);
 
-	close(xsvf_fd);
+	xsvf_unload();
 
-	command_print(CMD_CTX, "XSVF file programmed successfully");
-
-	return ERROR_OK;
+	return result;
 }
 
 static const struct command_registration xsvf_command_handlers[] = {